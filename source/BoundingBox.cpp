@@ -0,0 +1,33 @@
+#include "BoundingBox.h"
+
+#include <algorithm>
+#include <cfloat>
+
+BoundingBox::BoundingBox(void):lower(FLT_MAX),upper(-FLT_MAX)
+{
+}
+
+bool BoundingBox::Empty() const
+{
+    return this->lower.x > this->upper.x;
+}
+
+void BoundingBox::Add(const Vector3 &point)
+{
+    this->lower.x = std::min(this->lower.x, point.x);
+    this->lower.y = std::min(this->lower.y, point.y);
+    this->lower.z = std::min(this->lower.z, point.z);
+
+    this->upper.x = std::max(this->upper.x, point.x);
+    this->upper.y = std::max(this->upper.y, point.y);
+    this->upper.z = std::max(this->upper.z, point.z);
+}
+
+void BoundingBox::Add(const BoundingBox &box)
+{
+    if(!box.Empty())
+    {
+        this->Add(box.lower);
+        this->Add(box.upper);
+    }
+}
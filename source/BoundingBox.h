@@ -0,0 +1,51 @@
+/*!
+**  \file BoundingBox.h
+**  \brief Defines the BoundingBox class
+**
+**  \author Andrew James
+**  \sa BoundingBox
+*/
+#ifndef __BoundingBox
+#define __BoundingBox
+
+#include "Vector3.h"
+
+/*!
+**  \class BoundingBox
+**  \brief An axis aligned box around a bunch of points.
+**
+**  Starts out empty (lower above upper) and grows to fit whatever is added to it.
+*/
+class BoundingBox
+{
+public:
+    /*!
+    **  \brief No args constructor creates an empty box.
+    */
+    BoundingBox(void);
+
+    /*!
+    **  \brief Checks if anything has been added to the box.
+    **
+    **  \return Returns true if the box is empty.
+    */
+    bool Empty() const;
+
+    /*!
+    **  \brief Grows the box to fit a point.
+    **
+    **  \param point The point to fit.
+    */
+    void Add(const Vector3 &point);
+
+    /*!
+    **  \brief Grows the box to fit another box.
+    **
+    **  \param box The box to fit, nothing changes if it's empty.
+    */
+    void Add(const BoundingBox &box);
+
+    Vector3 lower,  //!< The smallest x, y and z of anything in the box.
+            upper;  //!< The largest x, y and z of anything in the box.
+};
+#endif
@@ -1,5 +1,7 @@
 #include "Box.h"
 
+#include "SimdVector3.h"
+
 #pragma comment(lib, "OpenGL32.lib")
 
 #include <cmath>
@@ -103,99 +105,228 @@ const GLfloat Box::colours[72] =
     1.0f, 1.0f, 0.0f,
 };
 
-Box::Box():angle(),axis(),next(),prev(),isActive(false)
+const GLubyte Box::indices[36] =
 {
-}
+     0,  1,  2,      0,  2,  3,
+     4,  5,  6,      4,  6,  7,
+     8,  9, 10,      8, 10, 11,
+    12, 13, 14,     12, 14, 15,
+    16, 17, 18,     16, 18, 19,
+    20, 21, 22,     20, 22, 23,
+};
 
-Box::Box(const Box &rhs):angle(rhs.angle),axis(rhs.axis),next(),prev(),isActive(false)
+const GLubyte Box::ALLFACES = 0x3F;
+const int Box::NOFACE = -1;
+
+const Box::Handle Box::NONE = 0xFFFFFFFF;
+
+Box::Box():angle(),axis(),next(NONE),prev(NONE),isActive(false),placement(),cell(),orientation(),dirty(true)
 {
-    SetNext(rhs.next);  // These two calls will most likely fail, we want this to happen.
-    SetPrev(rhs.prev.lock());
 }
 
-Box::Box(const float &_angle, const Vector3 &_axis):angle(_angle),axis(_axis),next(),prev(),isActive(false)
+Box::Box(const float &_angle, const Vector3 &_axis):angle(_angle),axis(_axis),next(NONE),prev(NONE),isActive(false),placement(),cell(),orientation(),dirty(true)
 {
 }
 
-void Box::operator=(const Box &rhs)
+const Matrix4 Box::LocalMatrix() const
 {
-    this->angle = rhs.angle;
-    this->axis = rhs.axis;
-    this->isActive = false; // Even if the rhs box is active, we only want one active box at a time.
+    if(Cardinal())
+    {
+        return Follow(Matrix4());
+    }
 
-    SetNext(rhs.next);  // These two calls will most likely fail, we want this to happen.
-    SetPrev(rhs.prev.lock());
+    return Matrix4::Translation(this->axis) * Matrix4::Rotation(this->axis, this->angle);
 }
 
-void Box::Draw() const
+const Matrix4 Box::Follow(const Matrix4 &previous) const
 {
-    glPushMatrix();
+    if(!Cardinal())
+    {
+        return previous * LocalMatrix();
+    }
 
-    glTranslatef(this->axis.x, this->axis.y, this->axis.z);
+    // Turning by the angle about -axis is the same as turning by -angle about axis.
+    int face = Face(this->axis);
+    int along = face % 3;
+    float sign = (face < 3) ? 1.0f : -1.0f;
+    float c, s;
+    Matrix4::SinCos(this->angle, s, c);
+    s *= sign;
 
-    glRotatef(angle, this->axis.x, this->axis.y, this->axis.z);
+    // The turn takes the next axis round towards the one after it.
+    const float *first = &previous.m[((along + 1) % 3) * 4];
+    const float *second = &previous.m[((along + 2) % 3) * 4];
+    Matrix4 result(previous);
 
-    if(this->isActive)
+    for(int row = 0; row < 4; ++row)
     {
-        glDrawArrays(GL_LINES, 0, 24);
+        result.m[12 + row] = previous.m[12 + row] + sign * previous.m[along * 4 + row];
+        result.m[((along + 1) % 3) * 4 + row] = c * first[row] + s * second[row];
+        result.m[((along + 2) % 3) * 4 + row] = c * second[row] - s * first[row];
     }
-    else
+
+    return result;
+}
+
+const DualQuaternion Box::Follow(const DualQuaternion &previous) const
+{   // Quaternions turn by half the angle.
+    float c, s;
+    Matrix4::SinCos(0.5f * this->angle, s, c);
+
+    if(!Cardinal())
     {
-        glDrawArrays(GL_QUADS, 0, 24);
-    }
+        Vector3 n = Vector3(this->axis).Normalise();
+        const float rotation[4] = { c, s * n.x, s * n.y, s * n.z };
 
-    if(this->next)
-    {   // Here's the trick! Drawing the elements recursively applies any
-        //  rotations to this box and all boxes further down the list.
-        this->next->Draw();
+        return previous * DualQuaternion(rotation, this->axis);
     }
 
-    glPopMatrix();
+    int face = Face(this->axis);
+    float sign = (face < 3) ? 1.0f : -1.0f;
+
+    return previous.Step(face % 3, c, sign * s, sign);
 }
 
 void Box::Rotate(const float &angle)
 {
     if(this->axis != Vector3(0))
     {   // Causes funny things to happen if you try rotate the head node.
-        this->angle += angle;
+        this->angle = fmod(this->angle + angle, 360.0f);
+        this->dirty = true;
     }
 }
 
-bool Box::SetNext(const boost::shared_ptr<Box> &next)
+bool Box::Accepts(const Box &next) const
 {
-    if(!next || ((&(*next) != this) && (next->axis != -this->axis)))
-    {   // Make sure you don't end up with a self reference,
-        //  otherwise the memory will not be freed properly.
-        // If the pointer is a null pointer we must be dropping
-        //  an element of the list, so allow it.
-        this->next = next;
+    return next.axis != -this->axis;
+}
 
-        return true;
+GLubyte Box::VisibleFaces(const Box *prev, const Box *next) const
+{
+    GLubyte faces = ALLFACES;
+
+    if(prev && !prev->isActive && this->Flush())
+    {   // We sit on the face of the previous box that points along our axis.
+        faces &= ~(1 << Face(-this->axis));
     }
 
-    return false;
+    if(next && !next->isActive && next->Flush())
+    {
+        faces &= ~(1 << Face(next->axis));
+    }
+
+    return faces;
 }
 
-bool Box::SetPrev(const boost::shared_ptr<Box> &prev)
+void Box::PlaceAfter(const Box &previous) const
 {
-    if(prev && (&(*(prev->Next())) == this))
-    {   //Make sure the previous pointer is valid, and actually links to this box.
-        this->prev = prev;
+    // Same test as Flush(), without paying for fmod on every box. Rotate() only ever steps in
+    //  whole degrees, so a multiple of 90 divides out exactly.
+    float quarters = this->angle / 90.0f;
 
-        return true;
+    if(previous.orientation.Exact() && quarters == floor(quarters) && Cardinal())
+    {
+        this->cell = previous.cell + previous.orientation.Rotate(OccupancyGrid::Cell(this->axis));
+        this->orientation = previous.orientation * Orientation(Face(this->axis), (static_cast<int>(quarters) % 4 + 4) % 4);
+        this->placement = this->orientation.Placement(this->cell);
     }
+    else
+    {   // Off the grid, and so is everything after it.
+        this->placement = Follow(previous.placement);
+        this->cell = OccupancyGrid::Cell(this->placement.Translation());
+        this->orientation = Orientation::Inexact();
+    }
+}
 
-    return false;
+void Box::PlaceWithin(const Box &frame) const
+{
+    if(frame.orientation.Exact() && this->orientation.Exact())
+    {
+        this->cell = frame.cell + frame.orientation.Rotate(this->cell);
+        this->orientation = frame.orientation * this->orientation;
+        this->placement = this->orientation.Placement(this->cell);
+    }
+    else
+    {
+        this->placement = frame.placement * this->placement;
+        this->cell = OccupancyGrid::Cell(this->placement.Translation());
+        this->orientation = Orientation::Inexact();
+    }
 }
 
-const boost::shared_ptr<Box> Box::Next(void)
+const Matrix4 Box::PlacementMatrix() const
+{
+    if(this->orientation.Exact())
+    {
+        return this->orientation.Matrix(this->cell);
+    }
+
+    return this->placement.Matrix();
+}
+
+bool Box::Cardinal() const
+{   // Two of the elements are zero, and the other one is plus or minus one.
+    float x = fabs(this->axis.x);
+    float y = fabs(this->axis.y);
+    float z = fabs(this->axis.z);
+
+    return (x + y + z == 1.0f) && (x == 1.0f || y == 1.0f || z == 1.0f);
+}
+
+int Box::Face(const Vector3 &direction)
+{   // Same order as the faces in Box::vertices.
+    if(direction.x > 0.5f)
+    {
+        return 0;
+    }
+    else if(direction.y > 0.5f)
+    {
+        return 1;
+    }
+    else if(direction.z > 0.5f)
+    {
+        return 2;
+    }
+    else if(direction.x < -0.5f)
+    {
+        return 3;
+    }
+    else if(direction.y < -0.5f)
+    {
+        return 4;
+    }
+
+    return 5;
+}
+
+int Box::Continues() const
+{
+    if(this->axis == Vector3(0) || fmod(this->angle, 360.0f) != 0.0f)
+    {
+        return NOFACE;
+    }
+
+    return Face(this->axis);
+}
+
+Box::Handle Box::Next() const
 {
     return this->next;
 }
 
-const boost::shared_ptr<Box> Box::Prev(void)
+Box::Handle Box::Prev() const
+{
+    return this->prev;
+}
+
+float Box::Angle() const
 {
-    return this->prev.lock();
+    return this->angle;
+}
+
+const Vector3 Box::Axis() const
+{
+    return this->axis;
 }
 
 void Box::Active(const bool &isActive)
@@ -203,55 +334,60 @@ void Box::Active(const bool &isActive)
     this->isActive = isActive;
 }
 
+bool Box::Flush() const
+{   // Rotate() only ever steps in whole degrees, so this is exact.
+    return fmod(this->angle, 90.0f) == 0.0f;
+}
 
-MasterBox::MasterBox():Box(),position(),forward(0.0f, 0.0f, 1.0f),right(1.0f, 0.0f, 0.0f),up(0.0f, 1.0f, 0.0f)
+
+MasterBox::MasterBox():Box(),position(),attitude(),stale(true)
 {
-    CalculateMatrix();
 }
 
-MasterBox::MasterBox(const Box &rhs):Box(rhs),position(),forward(0.0f, 0.0f, 1.0f),right(1.0f, 0.0f, 0.0f),up(0.0f, 1.0f, 0.0f)
+MasterBox::MasterBox(const Box &rhs):Box(rhs),position(),attitude(),stale(true)
 {
     this->axis = Vector3();
     this->angle = 0.0f;
-    CalculateMatrix();
+    this->prev = NONE;
+    this->placement = DualQuaternion();
+    this->cell = OccupancyGrid::Cell();
+    this->orientation = Orientation();
+    this->dirty = true;
 }
 
-MasterBox::MasterBox(const MasterBox &rhs):Box(rhs),position(rhs.position),forward(rhs.forward),right(rhs.right),up(rhs.up)
+MasterBox::MasterBox(const Vector3 &_position):Box(),position(_position),attitude(),stale(true)
 {
-    CalculateMatrix();
 }
 
-MasterBox::MasterBox(const Vector3 &_position):Box(),position(_position),forward(0.0f, 0.0f, 1.0f),right(1.0f, 0.0f, 0.0f),up(0.0f, 1.0f, 0.0f)
-{
-    CalculateMatrix();
+MasterBox::MasterBox(const Vector3 &_position, const Vector3 &_forward, const Vector3 &_right):Box(),position(_position),stale(true)
+{   // Up gets worked out from the other two.
+    Orient(_forward, _right);
 }
 
-MasterBox& MasterBox::operator=(const MasterBox &rhs)
+const Vector3 MasterBox::Position() const
 {
-    this->Box::operator=(rhs);
-    this->position = rhs.position;
-
-    return *this;
+    return this->position;
 }
 
 const Vector3 MasterBox::Forward() const
 {
-    return this->forward;
+    return this->attitude.Rotate(Vector3(0.0f, 0.0f, 1.0f));
 }
 
 const Vector3 MasterBox::Right() const
 {
-    return this->right;
+    return this->attitude.Rotate(Vector3(1.0f, 0.0f, 0.0f));
 }
 
 const Vector3 MasterBox::Up() const
 {
-    return this->up;
+    return this->attitude.Rotate(Vector3(0.0f, 1.0f, 0.0f));
 }
 
 void MasterBox::Dolly(const Vector3 &direction)
 {
     this->position += direction;
+    this->dirty = true;
 }
 
 void MasterBox::Roll(float angle)
@@ -270,62 +406,65 @@ void MasterBox::Yaw(float angle)
 }
 
 void MasterBox::Pan(const Quaternion &rotation)
-{
-    this->up *= rotation;
-    this->right *= rotation;
-    this->forward *= rotation;
-    CalculateMatrix();
+{   // The product keeps the quaternion unit length, so the axes never need straightening out.
+    this->attitude = rotation * this->attitude;
+    this->stale = true;
+    this->dirty = true;
 }
 
-void MasterBox::Draw() const
-{
-    glPushMatrix();
-
-    glTranslatef(this->position.x, this->position.y, this->position.z);
+void MasterBox::Turn(const Quaternion &rotation)
+{   // Rotating about the box's own axes is the same product the other way round.
+    this->attitude = this->attitude * rotation;
+    this->stale = true;
+    this->dirty = true;
+}
 
-    glMultMatrixf(this->matrix);
+const Matrix4 MasterBox::LocalMatrix() const
+{
+    return Matrix4::Translation(this->position) * Matrix();
+}
 
-    if(this->isActive)
-    {
-        glDrawArrays(GL_LINES, 0, 24);
-    }
-    else
-    {
-        glDrawArrays(GL_QUADS, 0, 24);
-    }
+const Matrix4 MasterBox::Follow(const Matrix4 &previous) const
+{
+    return previous * LocalMatrix();
+}
 
-    if(this->next)
-    {   // Here's the trick! Drawing the elements recursively applies any
-        //  rotations to this box and all boxes further down the list.
-        this->next->Draw();
-    }
+void MasterBox::Orient(const Vector3 &forward, const Vector3 &right)
+{   //Create an orthonormal set of axes from the forward and right vectors.
+    SimdVector3 facing(forward);
+    facing.Normalise();
+    SimdVector3 top = facing.Cross(SimdVector3(right));
+    top.Normalise();
+    SimdVector3 side = top.Cross(facing);
+    side.Normalise();
+
+    const Vector3 trueRight = side.Store(), up = top.Store(), trueForward = facing.Store();
+
+    // The axes are the columns of the rotation, so build it and read the quaternion back out.
+    Matrix4 rotation;
+    rotation.m[0] = trueRight.x;
+    rotation.m[1] = trueRight.y;
+    rotation.m[2] = trueRight.z;
+    //------------------
+    rotation.m[4] = up.x;
+    rotation.m[5] = up.y;
+    rotation.m[6] = up.z;
+    //------------------
+    rotation.m[8] = trueForward.x;
+    rotation.m[9] = trueForward.y;
+    rotation.m[10] = trueForward.z;
 
-    glPopMatrix();
+    this->attitude = rotation.ToQuaternion();
+    this->stale = true;
 }
 
-void MasterBox::CalculateMatrix()
-{   //Create an orthonormal set of axes from the forward and up vectors.
-    this->forward.Normalise();
-    this->up = this->forward.Cross(this->right);
-    this->up.Normalise();
-    this->right = this->up.Cross(this->forward);
-    this->right.Normalise();
+const Matrix4& MasterBox::Matrix() const
+{
+    if(this->stale)
+    {   // The rows are the axes, so it's the rotation backwards.
+        this->matrix = Matrix4::FromQuaternion(this->attitude.Conjugate());
+        this->stale = false;
+    }
 
-    this->matrix[0] = this->right.x;
-    this->matrix[4] = this->right.y;
-    this->matrix[8] = this->right.z;
-    this->matrix[12] = 0.0f;
-    //------------------
-    this->matrix[1] = this->up.x;
-    this->matrix[5] = this->up.y;
-    this->matrix[9] = this->up.z;
-    this->matrix[13] = 0.0f;
-    //------------------
-    this->matrix[2] = this->forward.x;
-    this->matrix[6] = this->forward.y;
-    this->matrix[10] = this->forward.z;
-    this->matrix[14] = 0.0f;
-    //------------------
-    this->matrix[3] = this->matrix[7] = this->matrix[11] = 0.0f;
-    this->matrix[15] = 1.0f;
+    return this->matrix;
 }
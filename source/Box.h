@@ -10,9 +10,9 @@
 
 #include "Vector3.h"
 #include "Quaternion.h"
-
-#include <boost/shared_ptr.hpp>
-#include <boost/weak_ptr.hpp>
+#include "Matrix4.h"
+#include "OccupancyGrid.h"
+#include "Orientation.h"
 
 #include <SDL_OpenGL.h>
 
@@ -21,15 +21,24 @@
 **  \brief Defines a unit cube with rotation about an axis.
 **
 **  Due to the cube being unit dimensions, the rotation axis is also used as the translation.
-**  Cubes draw themselves then the next cube in the list.
+**  Boxes are owned by a Pipe, and link to each other by handle (their index in the pipe)
+**   rather than by pointer.
 **  (Who knew learning about data structures would actually be useful?)
+**  \sa Pipe
 */
 class Box
 {
 public:
+    typedef unsigned int Handle;            //!< Identifies a box within its Pipe.
+
+    const static Handle NONE;               //!< Handle that doesn't refer to any box.
+
     const static GLfloat vertices[72];      //!< The vertices defining a box.
     const static GLfloat normals[72];       //!< The normals for each vertex.
     const static GLfloat colours[72];       //!< The colours for each vertex.
+    const static GLubyte indices[36];       //!< Two triangles for each face, indexing the arrays above.
+    const static GLubyte ALLFACES;          //!< Face mask with every face set, see VisibleFaces().
+    const static int NOFACE;                //!< Face index that doesn't refer to any face.
 
     /*!
     **  \brief Creates a unit cube with the specified rotation angle and axis.
@@ -41,56 +50,114 @@ public:
     Box(const float &_angle, const Vector3 &_axis);
 
     /*!
-    **  \brief Draws a unit cube with its own rotation and position
+    **  \brief Returns the transform from the previous box to this one.
     **
-    **  This will draw a box, rotate the world by its angle around its rotation axis,
-    **  then call the next boxes draw function. This *should* mean that the chain is
-    **  built correctly as all rotations will be applied to the current box and each
-    **  previous box.
+    **  A translation along the axis followed by a rotation by the angle about the axis.
+    **  \return The local transform of the box.
     */
-    virtual void Draw() const;
+    const Matrix4 LocalMatrix() const;
+
+    /*!
+    **  \brief Places the box after another one, same as previous * LocalMatrix().
+    **
+    **  Every box made from the number keys has one of the six unit axes, so stepping along
+    **   the axis just adds a column of previous to its translation, and turning about it
+    **   just mixes the other two columns. That's a sin/cos pair and 24 multiplies, where the
+    **   general case builds two matrices and multiplies three. Any other axis goes the long way.
+    **  \param previous Placement of the box before this one.
+    **  \return Placement of this box.
+    */
+    const Matrix4 Follow(const Matrix4 &previous) const;
+
+    /*!
+    **  \brief Places the box after another one, as a DualQuaternion.
+    **
+    **  The turn and the step along a unit axis each only have one element off the axis, so
+    **   this is 24 multiplies too, and half the floats to read and write.
+    **  \param previous Placement of the box before this one.
+    **  \return Placement of this box.
+    */
+    const DualQuaternion Follow(const DualQuaternion &previous) const;
 
     /*!
     **  \brief Rotates the box about its rotation axis.
     **
+    **  Marks the box dirty, so it and every box after it are transformed again on the next draw.
+    **  The angle is kept within one turn, so whole degree steps add up exactly however many
+    **   there are (see Matrix4::SinCos()).
+    **  Use Pipe::Rotate() on boxes that belong to a pipe, so the pipe can keep track of where
+    **   the boxes after this one end up.
     **  \param angle Rotation angle in radians.
     */
     void Rotate(const float &angle);
 
     /*!
-    **  \brief Adds a box to the next pointer.
+    **  \brief Checks if a box can follow this one.
+    **
+    **  A box that points straight back would be drawn inside this box, and we don't want that.
+    **  \param next The box that would follow this one.
+    **  \return Returns true if next can be linked after this box.
+    */
+    bool Accepts(const Box &next) const;
+
+    /*!
+    **  \brief Works out which faces of the box can be seen.
     **
-    **  Be careful about making a circular list.
-    **  \param next Pointer to the next box.
-    **  \return Returns true if the box was added to the list, false otherwise.
-    **          If the return value is false, the list has not been modified.
+    **  A face pressed flat against a neighbour is inside the pipe, so there's no point drawing it.
+    **   Neighbours only meet face to face when the later one is rotated a multiple of 90
+    **   degrees, any other angle leaves part of both faces sticking out.
+    **  The active box is drawn as lines, so faces touching it are always kept.
+    **  \param prev The previous box, 0 for the head.
+    **  \param next The next box, 0 for the tail.
+    **  \return One bit per face (in the order of Box::vertices), set if the face can be seen.
     */
-    bool SetNext(const boost::shared_ptr<Box> &next);
+    GLubyte VisibleFaces(const Box *prev, const Box *next) const;
 
     /*!
-    **  \brief Adds a box to the prev pointer.
+    **  \brief Returns the face of the box pointing in the given direction.
     **
-    **  Will only add a weak link, so the previous pointer needs to be held
-    **  somewhere or it will be deallocated automatically.
-    **  \param prev Pointer to the previous box.
-    **  \return Returns true if the box was added to the list, false otherwise.
-    **          If the return value is false, the list has not been modified.
+    **  \param direction One of the six axis directions.
+    **  \return Index of the face (0 to 5) in the order of Box::vertices.
     */
-    bool SetPrev(const boost::shared_ptr<Box> &prev);
+    static int Face(const Vector3 &direction);
 
     /*!
-    **  \brief Returns the next pointer.
+    **  \brief Checks if this box carries straight on from the previous box.
     **
-    **  \return The pointer to the next box.
+    **  A box that isn't rotated at all relative to the previous box has every face lined up
+    **   with it, so the faces of the two can be merged.
+    **  \return The face of the previous box this box sits on, or Box::NOFACE if this box is
+    **           rotated (or is the head).
     */
-    const boost::shared_ptr<Box> Next();
+    int Continues() const;
 
     /*!
-    **  \brief Returns the prev pointer.
+    **  \brief Returns the next handle.
     **
-    **  \return The pointer to the previous box.
+    **  \return The handle of the next box, or Box::NONE at the end of the pipe.
     */
-    const boost::shared_ptr<Box> Prev();
+    Handle Next() const;
+
+    /*!
+    **  \brief Returns the prev handle.
+    **
+    **  \return The handle of the previous box, or Box::NONE at the head of the pipe.
+    */
+    Handle Prev() const;
+
+    /*!
+    **  \brief Getter for the rotation angle.
+    **
+    **  \return The rotation angle in degrees.
+    */
+    float Angle() const;
+
+    /*!
+    **  \brief Getter for the rotation axis.
+    **
+    **  \return A copy of the rotation axis.
+    */
+    const Vector3 Axis() const;
 
     /*!
     **  \brief Sets the active state of the box.
@@ -104,11 +171,17 @@ protected:
     float angle;                    //!< The rotation angle.
     Vector3 axis;                   //!< The rotation axis also serves as the position.
 
-    boost::shared_ptr<Box> next;    //!< Pointer to the next box in the list.
-    boost::weak_ptr<Box> prev;      //!< Pointer to the previous box in the list.
+    Handle next;                    //!< Handle of the next box in the pipe.
+    Handle prev;                    //!< Handle of the previous box in the pipe.
 
     bool isActive;                  //!< Is the box currently selected?
 
+    mutable DualQuaternion placement;   //!< Transform from the head of the pipe to this box (kept up to date by the Pipe).
+    mutable OccupancyGrid::Cell cell;   //!< Cell the box takes up, relative to the head of the pipe.
+    mutable Orientation orientation;    //!< Which way the box faces relative to the head, exact while every box back to the head is.
+
+    mutable bool dirty;             //!< Does this box (and every box after it) need baking into the mesh again?
+
     /*!
     **  \brief No args constructor is provided for internal use only.
     **
@@ -117,18 +190,45 @@ protected:
     Box();
 
     /*!
-    **  \brief Copy constructor is provided for internal use only.
+    **  \brief Checks if this box lines up face to face with the previous box.
     **
-    **  \param rhs Box to copy.
+    **  \return Returns true if the angle is a multiple of 90 degrees.
     */
-    Box(const Box &rhs);
+    bool Flush() const;
 
     /*!
-    **  \brief Assignment operator is provided for internal use only.
+    **  \brief Checks if the axis is one of the six unit axes.
     **
-    **  \param rhs Box to copy.
+    **  \return Returns true if the axis is +/- x, y or z.
     */
-    void operator=(const Box &rhs);
+    bool Cardinal() const;
+
+    /*!
+    **  \brief Works out where the box is from where the box before it is.
+    **
+    **  While both boxes are on the grid this is whole numbers and a table lookup, otherwise
+    **   it's Follow() and the cell is rounded.
+    **  \param previous The box before this one.
+    */
+    void PlaceAfter(const Box &previous) const;
+
+    /*!
+    **  \brief Moves a box placed relative to some frame into the frame's real place.
+    **
+    **  \param frame Where the frame really is.
+    */
+    void PlaceWithin(const Box &frame) const;
+
+    /*!
+    **  \brief Returns the transform from the head of the pipe to this box, for baking.
+    **
+    **  Boxes on the grid are built straight from their orientation and cell, so they land
+    **   on exact whole numbers however far from the head they are.
+    **  \return The placement as a matrix.
+    */
+    const Matrix4 PlacementMatrix() const;
+
+    friend class Pipe;
 };
 
 /*!
@@ -152,6 +252,22 @@ public:
     */
     MasterBox(const Vector3 &_position);
 
+    /*!
+    **  \brief Creates a MasterBox with the specified position and orientation.
+    **
+    **  \param _position Vector3 describing the position of the box.
+    **  \param _forward The forward direction.
+    **  \param _right The right direction.
+    */
+    MasterBox(const Vector3 &_position, const Vector3 &_forward, const Vector3 &_right);
+
+    /*!
+    ** \brief Getter for the position.
+    **
+    ** \return A copy of the position.
+    */
+    const Vector3 Position() const;
+
     /*!
     ** \brief Getter for the forward vector.
     **
@@ -176,6 +292,7 @@ public:
     /*!
     **  \brief Moves the box in the specified direction.
     **
+    **  Marks the whole pipe dirty.
     **  \param direction Vector3 describing the direction and distance to move.
     */
     void Dolly(const Vector3 &direction);
@@ -183,10 +300,21 @@ public:
     /*!
     **  \brief Rotates the box.
     **
+    **  Marks the whole pipe dirty.
     **  \param rotation Quaternion describing the angle and axis of rotation.
     */
     void Pan(const Quaternion &rotation);
 
+    /*!
+    **  \brief Rotates the box about its own axes.
+    **
+    **  The axis is in box space (forward +z, up +y, right +x), so a run of Roll(), Pitch()
+    **   and Yaw() calls can be multiplied together first and applied in one go. Marks the
+    **   whole pipe dirty.
+    **  \param rotation Quaternion describing the angle and axis (in box space) of rotation.
+    */
+    void Turn(const Quaternion &rotation);
+
     /*!
     **  \brief Rolls the box by the specified angle.
     **
@@ -209,17 +337,26 @@ public:
     void Yaw(float angle);
 
     /*!
-    **  \brief Overloads Box::Draw to apply the correct translation.
+    **  \brief Hides Box::LocalMatrix to apply the position and orientation of the pipe.
+    **
+    **  \return The transform from world space to the head of the pipe.
+    */
+    const Matrix4 LocalMatrix() const;
+
+    /*!
+    **  \brief Hides Box::Follow, the head is always placed the long way.
+    **
+    **  \param previous Placement of whatever the pipe hangs off.
+    **  \return previous * LocalMatrix().
     */
-    void Draw() const;
+    const Matrix4 Follow(const Matrix4 &previous) const;
 
 protected:
-    Vector3 position,   //!< Position of the box.
-            forward,    //!< The forward direction.
-            right,      //!< The right direction.
-            up;         //!< The (drumroll please) up (*gasp*) direction.
+    Vector3 position;   //!< Position of the box.
+    Quaternion attitude;    //!< Turns the default axes (forward +z, up +y, right +x) to the box's.
 
-    GLfloat matrix[16]; //!< The calculated rotation matrix.
+    mutable Matrix4 matrix; //!< The calculated rotation matrix, worked out the next time it's needed.
+    mutable bool stale;     //!< Has the box turned since the matrix was worked out?
 
     /*!
     **  \brief No args constructor is provided for internal use only.
@@ -229,22 +366,20 @@ protected:
     MasterBox();
 
     /*!
-    **  \brief Copy constructor provided for internal use only.
+    **  \brief Points the box down the forward axis with right as near to the given right as it'll go.
     **
-    **  \param rhs MasterBox to copy
+    **  \param forward The forward direction.
+    **  \param right The right direction.
     */
-    MasterBox(const MasterBox &rhs);
+    void Orient(const Vector3 &forward, const Vector3 &right);
 
     /*!
-    **  \brief Assignment operator provided for internal use only.
+    **  \brief Returns the rotation matrix, working it out again if the box has turned.
     **
-    **  \param rhs MasterBox to copy.
-    */
-    MasterBox& operator=(const MasterBox &rhs);
-
-    /*!
-    **  \brief Calculates the rotation matrix.
+    **  Working it out writes to the cache, so this (and LocalMatrix()) mustn't be called from
+    **   two threads at once. Jobs are handed a copy instead, see Pipe::Prepare().
+    **  \return The rotation matrix, the rows are the right, up and forward vectors.
     */
-    void CalculateMatrix();
+    const Matrix4& Matrix() const;
 };
 #endif
@@ -1,5 +1,7 @@
 #include "Camera.h"
 
+#include "SimdVector3.h"
+
 #include <cmath>
 
 Camera::Camera(const Vector3 &position,
@@ -8,55 +10,66 @@ Camera::Camera(const Vector3 &position,
                const Vector3 &right)
                :
                position(position),
-               forward(forward),
-               right(right),
-               up(up)
+               stale(true)
 {
-    CalculateMatrix();
+    Orient(forward, up);
 }
 
 
-void Camera::CalculateMatrix()
+void Camera::Orient(const Vector3 &forward, const Vector3 &up)
 {   //Create an orthonormal set of axes from the forward and up vectors.
-    this->forward.Normalise();
-    this->right = this->forward.Cross(this->up);
-    this->right.Normalise();
-    this->up = this->right.Cross(this->forward);
-    this->up.Normalise();
-
-    this->matrix[0] = this->right.x;
-    this->matrix[4] = this->right.y;
-    this->matrix[8] = this->right.z;
-    this->matrix[12] = 0.0f;
-    //------------------
-    this->matrix[1] = this->up.x;
-    this->matrix[5] = this->up.y;
-    this->matrix[9] = this->up.z;
-    this->matrix[13] = 0.0f;
+    SimdVector3 facing(forward);
+    facing.Normalise();
+    SimdVector3 side = facing.Cross(SimdVector3(up));
+    side.Normalise();
+    SimdVector3 top = side.Cross(facing);
+    top.Normalise();
+
+    const Vector3 right = side.Store(), trueUp = top.Store(), back = -facing.Store();
+
+    // The axes are the columns of the rotation, so build it and read the quaternion back out.
+    Matrix4 rotation;
+    rotation.m[0] = right.x;
+    rotation.m[1] = right.y;
+    rotation.m[2] = right.z;
     //------------------
-    this->matrix[2] = -this->forward.x;
-    this->matrix[6] = -this->forward.y;
-    this->matrix[10] = -this->forward.z;
-    this->matrix[14] = 0.0f;
+    rotation.m[4] = trueUp.x;
+    rotation.m[5] = trueUp.y;
+    rotation.m[6] = trueUp.z;
     //------------------
-    this->matrix[3] = this->matrix[7] = this->matrix[11] = 0.0f;
-    this->matrix[15] = 1.0f;
+    rotation.m[8] = back.x;
+    rotation.m[9] = back.y;
+    rotation.m[10] = back.z;
+
+    this->attitude = rotation.ToQuaternion();
+    this->stale = true;
+}
+
+const Matrix4& Camera::Matrix() const
+{
+    if(this->stale)
+    {
+        this->matrix = Matrix4::FromQuaternion(this->attitude);
+        this->stale = false;
+    }
+
+    return this->matrix;
 }
 
 
 const Vector3 Camera::Forward() const
 {
-    return this->forward;
+    return this->attitude.Rotate(Vector3(0.0f, 0.0f, -1.0f));
 }
 
 const Vector3 Camera::Right() const
 {
-    return this->right;
+    return this->attitude.Rotate(Vector3(1.0f, 0.0f, 0.0f));
 }
 
 const Vector3 Camera::Up() const
 {
-    return this->up;
+    return this->attitude.Rotate(Vector3(0.0f, 1.0f, 0.0f));
 }
 
 const Vector3 Camera::Position() const
@@ -66,11 +79,15 @@ const Vector3 Camera::Position() const
 
 
 void Camera::Pan(const Quaternion &rotation)
-{
-    this->forward *= rotation;
-    this->right *= rotation;
-    this->up *= rotation;
-    CalculateMatrix();
+{   // The product keeps the quaternion unit length, so the axes never need straightening out.
+    this->attitude = rotation * this->attitude;
+    this->stale = true;
+}
+
+void Camera::Turn(const Quaternion &rotation)
+{   // Rotating about the camera's own axes is the same product the other way round.
+    this->attitude = this->attitude * rotation;
+    this->stale = true;
 }
 
 void Camera::Roll(float angle)
@@ -90,13 +107,7 @@ void Camera::Yaw(float angle)
 
 void Camera::LookAt(const Vector3 &target, const Vector3 &up)
 {
-    this->forward = target - this->position;
-    this->forward.Normalise();
-
-    this->up = up;
-    this->up.Normalise();
-
-    CalculateMatrix();
+    Orient(target - this->position, up);
 }
 
 void Camera::Dolly(const Vector3 &direction)
@@ -126,6 +137,10 @@ void Camera::MoveTo(const Vector3 &position)
 
 void Camera::Render() const
 {
-    glMultMatrixf(this->matrix);
-    glTranslatef(-this->position.x, -this->position.y, -this->position.z);
+    glMultMatrixf(ViewMatrix().m);
+}
+
+const Matrix4 Camera::ViewMatrix() const
+{
+    return (Matrix4::Translation(this->position) * Matrix()).RigidInverse();
 }
@@ -9,12 +9,17 @@
 
 #include "Vector3.h"
 #include "Quaternion.h"
+#include "Matrix4.h"
 
 #include <SDL_OpenGL.h>
 
 /*!
 **  \class Camera
 **  \brief Basic camera functionality implemented (pan/dolly and derivatives).
+**
+**  The orientation is kept as a quaternion, so turning is one quaternion product and
+**   rounding can't skew the axes. The matrix is only worked out when it's needed, so a
+**   camera turned several times a frame only pays for it once.
 */
 class Camera
 {
@@ -90,6 +95,17 @@ public:
     */
     void Pan(const Quaternion &rotation);
 
+    /*!
+    **  \brief Rotates the view about the camera's own axes, without moving the camera.
+    **
+    **  The axis is in camera space (forward -z, up +y, right +x), so a run of Roll(),
+    **   Pitch() and Yaw() calls can be multiplied together first and applied in one go.
+    **   Turn(Quaternion(Vector3(1.0f, 0.0f, 0.0f), angle)) is the same as Pitch(angle).
+    **  \param rotation Quaternion defining the rotation axis (in camera space) and angle.
+    **  \sa Pan
+    */
+    void Turn(const Quaternion &rotation);
+
     /*!
     **  \brief Rolls the camera by the specified angle.
     **
@@ -184,17 +200,32 @@ public:
     */
     void Render() const;
 
+    /*!
+    **  \brief Returns the view matrix, the same one Render() sets.
+    **  \return The view matrix.
+    */
+    const Matrix4 ViewMatrix() const;
+
 protected:
-    Vector3 position,   //!< Position of the camera.
-            forward,    //!< The forward direction.
-            right,      //!< The side direction.
-            up;         //!< The (drumroll please) up (*gasp*) direction.
+    Vector3 position;   //!< Position of the camera.
+    Quaternion attitude;    //!< Turns the default axes (forward -z, up +y, right +x) to the camera's.
+
+    mutable Matrix4 matrix; //!< The camera's rotation, worked out the next time it's needed.
+    mutable bool stale;     //!< Has the camera turned since the matrix was worked out?
 
-    GLfloat matrix[16]; //!< The calculated view matrix.
+    /*!
+    **  \brief Points the camera down the forward axis with up as near to the given up as it'll go.
+    **
+    **  \param forward Direction the camera is looking.
+    **  \param up Up direction of the camera.
+    */
+    void Orient(const Vector3 &forward, const Vector3 &up);
 
     /*!
-    **  \brief Calculates the view matrix.
+    **  \brief Returns the camera's rotation, working it out again if the camera has turned.
+    **
+    **  \return The rotation matrix, the columns are the right, up and back vectors.
     */
-    void CalculateMatrix();
+    const Matrix4& Matrix() const;
 };
 #endif
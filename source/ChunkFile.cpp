@@ -0,0 +1,141 @@
+#include "ChunkFile.h"
+
+#include "Matrix4.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+const char ChunkFile::MAGIC[4] = {'P', 'C', 'H', 'K'};
+const boost::uint32_t ChunkFile::VERSION = 1;
+
+bool ChunkFile::Key::operator<(const Key &rhs) const
+{
+    if(this->x != rhs.x)
+    {
+        return this->x < rhs.x;
+    }
+
+    if(this->y != rhs.y)
+    {
+        return this->y < rhs.y;
+    }
+
+    return this->z < rhs.z;
+}
+
+bool ChunkFile::Key::operator==(const Key &rhs) const
+{
+    return this->x == rhs.x && this->y == rhs.y && this->z == rhs.z;
+}
+
+const ChunkFile::Key ChunkFile::KeyOf(const Vector3 &position, const float &size)
+{
+    Key key = {static_cast<boost::int32_t>(floor(position.x / size)),
+               static_cast<boost::int32_t>(floor(position.y / size)),
+               static_cast<boost::int32_t>(floor(position.z / size))};
+
+    return key;
+}
+
+ChunkFile::Chunk::Chunk(void):pipes(0),data()
+{
+}
+
+void ChunkFile::AddPiece(Chunk &chunk, const MasterBox &head, const std::vector<SceneFile::BoxRecord> &boxes)
+{
+    SceneFile::PipeRecord pipe = SceneFile::MakePipeRecord(head, static_cast<boost::uint32_t>(boxes.size()));
+    const char *first = reinterpret_cast<const char*>(&pipe);
+
+    chunk.data.insert(chunk.data.end(), first, first + sizeof(pipe));
+
+    if(!boxes.empty())
+    {
+        first = reinterpret_cast<const char*>(&boxes[0]);
+        chunk.data.insert(chunk.data.end(), first, first + boxes.size() * sizeof(SceneFile::BoxRecord));
+    }
+
+    ++chunk.pipes;
+}
+
+bool ChunkFile::Save(const std::string &filename, const std::list<Pipe> &pipes, const float &size)
+{
+    std::map<Key, Chunk> chunks;
+    std::vector<SceneFile::BoxRecord> boxes;
+
+    for(std::list<Pipe>::const_iterator it = pipes.begin(); it != pipes.end(); ++it)
+    {   // Walk the pipe in world space, starting a new piece whenever it crosses into another chunk.
+        MasterBox head = it->Head();
+        Matrix4 world = head.LocalMatrix();
+        Key key = KeyOf(head.Position(), size);
+
+        boxes.clear();
+
+        for(Box::Handle handle = head.Next(); handle != Box::NONE; handle = (*it)[handle].Next())
+        {
+            const Box &box = (*it)[handle];
+
+            world = box.Follow(world);
+
+            Vector3 position(world.m[12], world.m[13], world.m[14]);
+            Key next = KeyOf(position, size);
+
+            if(next == key)
+            {
+                boxes.push_back(SceneFile::MakeBoxRecord(box));
+                continue;
+            }
+
+            AddPiece(chunks[key], head, boxes);
+
+            // The rows of a MasterBox's matrix are its right, up and forward vectors.
+            head = MasterBox(position, Vector3(world.m[2], world.m[6], world.m[10]), Vector3(world.m[0], world.m[4], world.m[8]));
+            key = next;
+            boxes.clear();
+        }
+
+        AddPiece(chunks[key], head, boxes);
+    }
+
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if(!file)
+    {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.chunks = static_cast<boost::uint32_t>(chunks.size());
+    header.size = size;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // The chunks go straight after the table of where they are.
+    boost::uint64_t offset = sizeof(Header) + chunks.size() * sizeof(ChunkRecord);
+
+    for(std::map<Key, Chunk>::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
+    {
+        ChunkRecord record;
+        record.key = it->first;
+        record.pipes = it->second.pipes;
+        record.offset = offset;
+        record.size = sizeof(SceneFile::Header) + it->second.data.size();
+
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+
+        offset += record.size;
+    }
+
+    for(std::map<Key, Chunk>::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
+    {
+        SceneFile::Header scene = SceneFile::MakeHeader(it->second.pipes);
+
+        file.write(reinterpret_cast<const char*>(&scene), sizeof(scene));
+        file.write(&it->second.data[0], it->second.data.size());
+    }
+
+    return file.good();
+}
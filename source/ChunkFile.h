@@ -0,0 +1,133 @@
+/*!
+**  \file ChunkFile.h
+**  \brief Defines the ChunkFile class
+**
+**  \author Andrew James
+**  \sa ChunkFile
+*/
+#ifndef __ChunkFile
+#define __ChunkFile
+
+#include "Pipe.h"
+#include "SceneFile.h"
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+/*!
+**  \class ChunkFile
+**  \brief Saves pipes split up into cubic chunks of space, so they can be streamed in bits.
+**
+**  The file is a Header, then a ChunkRecord for every chunk, then the chunks themselves.
+**   Each chunk is a complete scene in the SceneFile format holding the parts of the pipes
+**   that fall inside it, so loading a chunk is just SceneFile::Read() on its bytes.
+**  Pipes that wander from one chunk to another are cut where they cross. The first box in
+**   the new chunk becomes the head of a new pipe, with its position and orientation set to
+**   where that box was in the world, so the pieces line up exactly when drawn.
+**  \sa SceneStreamer
+*/
+class ChunkFile
+{
+public:
+    const static char MAGIC[4];             //!< The first four bytes of every chunk file.
+    const static boost::uint32_t VERSION;   //!< Version of the format written by Save().
+
+    /*!
+    **  \struct Key
+    **  \brief Integer coordinates of a chunk.
+    */
+    struct Key
+    {
+        boost::int32_t x,   //!< The x coordinate.
+                       y,   //!< The y coordinate.
+                       z;   //!< The z coordinate.
+
+        /*!
+        **  \brief Orders keys so they can go in a std::map.
+        **
+        **  \param rhs The key to compare with.
+        **  \return Returns true if this key comes before rhs.
+        */
+        bool operator<(const Key &rhs) const;
+
+        /*!
+        **  \brief Compares two keys.
+        **
+        **  \param rhs The key to compare with.
+        **  \return Returns true if the keys are the same.
+        */
+        bool operator==(const Key &rhs) const;
+    };
+
+    /*!
+    **  \struct Header
+    **  \brief Start of the file.
+    */
+    struct Header
+    {
+        char magic[4];              //!< Always ChunkFile::MAGIC.
+        boost::uint32_t version;    //!< Format version.
+        boost::uint32_t chunks;     //!< Number of chunks in the file.
+        float size;                 //!< Length of the side of a chunk.
+    };
+
+    /*!
+    **  \struct ChunkRecord
+    **  \brief Where to find a chunk in the file.
+    */
+    struct ChunkRecord
+    {
+        Key key;                    //!< Which chunk this is.
+        boost::uint32_t pipes;      //!< Number of pipes (or pieces of pipes) in the chunk.
+        boost::uint64_t offset;     //!< Offset of the chunk from the start of the file.
+        boost::uint64_t size;       //!< Size of the chunk in bytes.
+    };
+
+    /*!
+    **  \brief Works out which chunk a point is in.
+    **
+    **  \param position The point.
+    **  \param size Length of the side of a chunk.
+    **  \return The key of the chunk.
+    */
+    static const Key KeyOf(const Vector3 &position, const float &size);
+
+    /*!
+    **  \brief Writes the pipes to a file, split into chunks.
+    **
+    **  \param filename The file to write.
+    **  \param pipes The pipes to save.
+    **  \param size Length of the side of a chunk.
+    **  \return Returns true if the file was written.
+    */
+    static bool Save(const std::string &filename, const std::list<Pipe> &pipes, const float &size);
+
+protected:
+    /*!
+    **  \struct Chunk
+    **  \brief A chunk being put together by Save().
+    */
+    struct Chunk
+    {
+        /*!
+        **  \brief Creates an empty chunk.
+        */
+        Chunk(void);
+
+        boost::uint32_t pipes;      //!< Number of pipes added so far.
+        std::vector<char> data;     //!< The pipe and box records, everything but the header.
+    };
+
+    /*!
+    **  \brief Adds a piece of a pipe to a chunk.
+    **
+    **  \param chunk The chunk to add to.
+    **  \param head The head of the piece.
+    **  \param boxes The boxes after the head.
+    */
+    static void AddPiece(Chunk &chunk, const MasterBox &head, const std::vector<SceneFile::BoxRecord> &boxes);
+};
+#endif
@@ -0,0 +1,33 @@
+#include "Detail.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+const float Detail::COARSE = 2.0f;
+const float Detail::FINE = 3.0f;
+
+Detail::Detail(void):eye(),scale(FLT_MAX)
+{
+}
+
+Detail::Detail(const Vector3 &eye, const float &scale):eye(eye),scale(scale)
+{
+}
+
+bool Detail::Coarse(const BoundingBox &box, const bool &coarse) const
+{
+    if(box.Empty())
+    {
+        return false;
+    }
+
+    // Distance to the nearest point of the box (zero if we're inside it).
+    Vector3 offset(std::max(std::max(box.lower.x - this->eye.x, this->eye.x - box.upper.x), 0.0f),
+                   std::max(std::max(box.lower.y - this->eye.y, this->eye.y - box.upper.y), 0.0f),
+                   std::max(std::max(box.lower.z - this->eye.z, this->eye.z - box.upper.z), 0.0f));
+    float distance = sqrt(offset.Dot(offset));
+
+    // A box covers scale / distance pixels, multiplied out to keep clear of dividing by zero.
+    return this->scale < (coarse ? FINE : COARSE) * distance;
+}
@@ -0,0 +1,54 @@
+/*!
+**  \file Detail.h
+**  \brief Defines the Detail class
+**
+**  \author Andrew James
+**  \sa Detail
+*/
+#ifndef __Detail
+#define __Detail
+
+#include "BoundingBox.h"
+
+/*!
+**  \class Detail
+**  \brief Decides when things are far enough away to be drawn with less detail.
+**
+**  Works from how many pixels a box (one unit across) would cover at the nearest point of
+**   something's bounds. Things switch to low detail when a box gets smaller than COARSE
+**   pixels, but don't switch back until a box is bigger than FINE pixels, so something
+**   sitting right on the limit doesn't flicker between the two.
+*/
+class Detail
+{
+public:
+    const static float COARSE;  //!< Boxes smaller than this many pixels are drawn in low detail.
+    const static float FINE;    //!< Boxes in low detail go back to full detail once they're bigger than this many pixels.
+
+    /*!
+    **  \brief No args constructor draws everything at full detail.
+    */
+    Detail(void);
+
+    /*!
+    **  \brief Creates a Detail for a camera.
+    **
+    **  \param eye Where the camera is.
+    **  \param scale How many pixels one unit covers, one unit in front of the camera.
+    */
+    Detail(const Vector3 &eye, const float &scale);
+
+    /*!
+    **  \brief Decides if something should be drawn in low detail.
+    **
+    **  \param box The bounds of the thing.
+    **  \param coarse Is it in low detail now?
+    **  \return Returns true if it should be in low detail.
+    */
+    bool Coarse(const BoundingBox &box, const bool &coarse) const;
+
+protected:
+    Vector3 eye;    //!< Where the camera is.
+    float scale;    //!< How many pixels one unit covers, one unit in front of the camera.
+};
+#endif
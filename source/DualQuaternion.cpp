@@ -0,0 +1,129 @@
+#include "DualQuaternion.h"
+
+DualQuaternion::DualQuaternion(void)
+{
+    for(int i = 0; i < 4; ++i)
+    {
+        this->real[i] = (i == 0) ? 1.0f : 0.0f;
+        this->dual[i] = 0.0f;
+    }
+}
+
+DualQuaternion::DualQuaternion(const Quaternion &rotation, const Vector3 &translation)
+{
+    const float parts[4] = { rotation.w, rotation.xyz.x, rotation.xyz.y, rotation.xyz.z };
+
+    *this = DualQuaternion(parts, translation);
+}
+
+DualQuaternion::DualQuaternion(const float *rotation, const Vector3 &translation)
+{   // The translation as a quaternion with no w, halved.
+    const float half[4] = { 0.0f, 0.5f * translation.x, 0.5f * translation.y, 0.5f * translation.z };
+
+    for(int i = 0; i < 4; ++i)
+    {
+        this->real[i] = rotation[i];
+    }
+
+    Multiply(half, this->real, this->dual);
+}
+
+const DualQuaternion DualQuaternion::operator*(const DualQuaternion &rhs) const
+{
+    DualQuaternion result;
+    float cross[4];
+
+    Multiply(this->real, rhs.real, result.real);
+    Multiply(this->real, rhs.dual, result.dual);
+    Multiply(this->dual, rhs.real, cross);
+
+    for(int i = 0; i < 4; ++i)
+    {
+        result.dual[i] += cross[i];
+    }
+
+    return result;
+}
+
+const DualQuaternion DualQuaternion::Step(const int &along, const float &c, const float &s, const float &translate) const
+{   // The step's dual part is half of (0, translate * axis) * (c, s * axis), which is (w, v * axis) below.
+    //  Multiplying by a quaternion with a single axis only moves the other two elements around.
+    int k = along + 1;
+    int first = (along + 1) % 3 + 1;
+    int second = (along + 2) % 3 + 1;
+    float w = -0.5f * translate * s;
+    float v = 0.5f * translate * c;
+
+    const float r0 = this->real[0], rk = this->real[k], r1 = this->real[first], r2 = this->real[second];
+    const float d0 = this->dual[0], dk = this->dual[k], d1 = this->dual[first], d2 = this->dual[second];
+    DualQuaternion result;
+
+    result.real[0] = c * r0 - s * rk;
+    result.real[k] = c * rk + s * r0;
+    result.real[first] = c * r1 + s * r2;
+    result.real[second] = c * r2 - s * r1;
+
+    result.dual[0] = c * d0 - s * dk + w * r0 - v * rk;
+    result.dual[k] = c * dk + s * d0 + w * rk + v * r0;
+    result.dual[first] = c * d1 + s * d2 + w * r1 + v * r2;
+    result.dual[second] = c * d2 - s * d1 + w * r2 - v * r1;
+
+    return result;
+}
+
+const Vector3 DualQuaternion::Translation() const
+{   // 2 * dual * conjugate(real), divided by the length of real squared in case it has drifted.
+    const float *r = this->real;
+    const float *d = this->dual;
+    float scale = 2.0f / (r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3]);
+
+    return Vector3(scale * (r[0] * d[1] - d[0] * r[1] + r[2] * d[3] - r[3] * d[2]),
+                   scale * (r[0] * d[2] - d[0] * r[2] + r[3] * d[1] - r[1] * d[3]),
+                   scale * (r[0] * d[3] - d[0] * r[3] + r[1] * d[2] - r[2] * d[1]));
+}
+
+const Vector3 DualQuaternion::TransformPoint(const Vector3 &point) const
+{   // real * point * conjugate(real), expanded out.
+    const float w = this->real[0];
+    Vector3 v(this->real[1], this->real[2], this->real[3]);
+    float length = w * w + v.Dot(v);
+
+    return (point * (w * w - v.Dot(v)) + v * (2.0f * v.Dot(point)) + v.Cross(point) * (2.0f * w)) / length + Translation();
+}
+
+const Matrix4 DualQuaternion::Matrix() const
+{
+    const float w = this->real[0];
+    const float x = this->real[1];
+    const float y = this->real[2];
+    const float z = this->real[3];
+    float scale = 2.0f / (w * w + x * x + y * y + z * z);
+    Vector3 translation = Translation();
+    Matrix4 result;
+
+    result.m[0] = 1.0f - scale * (y * y + z * z);
+    result.m[1] = scale * (x * y + w * z);
+    result.m[2] = scale * (x * z - w * y);
+    //------------------
+    result.m[4] = scale * (x * y - w * z);
+    result.m[5] = 1.0f - scale * (x * x + z * z);
+    result.m[6] = scale * (y * z + w * x);
+    //------------------
+    result.m[8] = scale * (x * z + w * y);
+    result.m[9] = scale * (y * z - w * x);
+    result.m[10] = 1.0f - scale * (x * x + y * y);
+    //------------------
+    result.m[12] = translation.x;
+    result.m[13] = translation.y;
+    result.m[14] = translation.z;
+
+    return result;
+}
+
+void DualQuaternion::Multiply(const float *lhs, const float *rhs, float *result)
+{
+    result[0] = lhs[0] * rhs[0] - lhs[1] * rhs[1] - lhs[2] * rhs[2] - lhs[3] * rhs[3];
+    result[1] = lhs[0] * rhs[1] + lhs[1] * rhs[0] + lhs[2] * rhs[3] - lhs[3] * rhs[2];
+    result[2] = lhs[0] * rhs[2] + lhs[2] * rhs[0] + lhs[3] * rhs[1] - lhs[1] * rhs[3];
+    result[3] = lhs[0] * rhs[3] + lhs[3] * rhs[0] + lhs[1] * rhs[2] - lhs[2] * rhs[1];
+}
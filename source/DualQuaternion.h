@@ -0,0 +1,108 @@
+/*!
+**  \file DualQuaternion.h
+**  \brief Defines the DualQuaternion class
+**
+**  \author Andrew James
+**  \sa DualQuaternion
+*/
+#ifndef __DualQuaternion
+#define __DualQuaternion
+
+#include "Vector3.h"
+#include "Quaternion.h"
+#include "Matrix4.h"
+
+/*!
+**  \class DualQuaternion
+**  \brief A rotation followed by a translation, in 8 floats instead of a Matrix4's 16.
+**
+**  The real part is the rotation, the dual part is half the translation times the rotation.
+**   Composing two of them is three quaternion products (48 multiplies, where a Matrix4 takes
+**   64), and there's half as much to read and write for every box placed.
+**  Quaternion normalises everything it touches, which the dual part can't have, so the parts
+**   are kept as plain (w, x, y, z) arrays. Turn one into a Matrix4 with Matrix() when it's
+**   time to hand it to something that wants a matrix.
+*/
+class DualQuaternion
+{
+public:
+    /*!
+    **  \brief No args constructor creates the identity transform.
+    */
+    DualQuaternion(void);
+
+    /*!
+    **  \brief Creates a transform that rotates then translates.
+    **
+    **  \param rotation The rotation.
+    **  \param translation The translation.
+    */
+    DualQuaternion(const Quaternion &rotation, const Vector3 &translation);
+
+    /*!
+    **  \brief Creates a transform that rotates then translates.
+    **
+    **  \param rotation The rotation as a unit quaternion (w, x, y, z).
+    **  \param translation The translation.
+    */
+    DualQuaternion(const float *rotation, const Vector3 &translation);
+
+    /*!
+    **  \brief Multiplies self by the given DualQuaternion and returns the result.
+    **
+    **  The rhs is applied first, same as Matrix4::operator*().
+    **  \param rhs The rhs of the multiplication.
+    **  \return The result of the multiplication.
+    */
+    const DualQuaternion operator*(const DualQuaternion &rhs) const;
+
+    /*!
+    **  \brief Applies a rotation about one of the three axes, then a translation along it.
+    **
+    **  The same as multiplying by DualQuaternion((c, s * axis), translate * axis), but both
+    **   of those only have one element off the axis so most of the products drop out.
+    **  \param along The axis (0, 1 or 2 for x, y or z).
+    **  \param c Cosine of half the rotation angle.
+    **  \param s Sine of half the rotation angle.
+    **  \param translate Distance to translate along the axis.
+    **  \return The result of the multiplication.
+    */
+    const DualQuaternion Step(const int &along, const float &c, const float &s, const float &translate) const;
+
+    /*!
+    **  \brief Returns the translation.
+    **
+    **  \return Where the origin ends up.
+    */
+    const Vector3 Translation() const;
+
+    /*!
+    **  \brief Transforms a point (rotation then translation).
+    **
+    **  \param point The point to transform.
+    **  \return The transformed point.
+    */
+    const Vector3 TransformPoint(const Vector3 &point) const;
+
+    /*!
+    **  \brief Converts to a matrix.
+    **
+    **  Rounding errors that have crept into the length of the rotation are divided back out.
+    **  \return The matrix doing the same transform.
+    */
+    const Matrix4 Matrix() const;
+
+    float real[4];  //!< The rotation (w, x, y, z).
+    float dual[4];  //!< Half the translation times the rotation (w, x, y, z).
+
+protected:
+    /*!
+    **  \brief Multiplies two quaternions stored as (w, x, y, z).
+    **
+    **  \param lhs The lhs of the multiplication.
+    **  \param rhs The rhs of the multiplication.
+    **  \param result Where to write the result (mustn't be lhs or rhs).
+    */
+    static void Multiply(const float *lhs, const float *rhs, float *result);
+};
+#endif
@@ -0,0 +1,89 @@
+#include "FrameTimer.h"
+#include "GLExtensions.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+
+const int FrameTimer::QUERIES = 2;
+
+FrameTimer::FrameTimer():current(0),gpu(0.0f),vsync(true),started(),previous()
+{
+    int swapControl = 0;
+
+    // Unknown counts as on, the interval between frames would be the refresh rate then.
+    this->vsync = SDL_GL_GetAttribute(SDL_GL_SWAP_CONTROL, &swapControl) != 0 || swapControl != 0;
+
+    for(int query = 0; query < QUERIES; ++query)
+    {
+        this->queries[query] = 0;
+        this->pending[query] = false;
+    }
+
+    if(GLExtensions::HasTimerQueries())
+    {
+        GLExtensions::glGenQueries(QUERIES, this->queries);
+    }
+}
+
+FrameTimer::~FrameTimer()
+{
+    if(this->queries[0])
+    {
+        GLExtensions::glDeleteQueries(QUERIES, this->queries);
+    }
+}
+
+void FrameTimer::Start()
+{
+    this->previous = this->started;
+    this->started = boost::posix_time::microsec_clock::local_time();
+
+    if(this->queries[0])
+    {   // If the GPU is more than a frame behind this query's last result is lost, the next one will do.
+        GLExtensions::glBeginQuery(GL_TIME_ELAPSED_EXT, this->queries[this->current]);
+    }
+}
+
+float FrameTimer::Stop()
+{
+    boost::posix_time::ptime finished(boost::posix_time::microsec_clock::local_time());
+    float cpu = static_cast<float>((finished - this->started).total_microseconds()) / 1000.0f;
+
+    if(this->queries[0])
+    {
+        GLExtensions::glEndQuery(GL_TIME_ELAPSED_EXT);
+        this->pending[this->current] = true;
+        this->current = (this->current + 1) % QUERIES;
+
+        GLint available = 0;
+
+        if(this->pending[this->current])
+        {   // Last frame's query, asking if it's done doesn't wait for it.
+            GLExtensions::glGetQueryObjectiv(this->queries[this->current], GL_QUERY_RESULT_AVAILABLE, &available);
+        }
+
+        if(available)
+        {
+            GLuint64EXT elapsed = 0;
+
+            GLExtensions::glGetQueryObjectui64v(this->queries[this->current], GL_QUERY_RESULT, &elapsed);
+            this->pending[this->current] = false;
+            this->gpu = static_cast<float>(elapsed / 1000) / 1000.0f;
+
+            if(!this->previous.is_not_a_date_time())
+            {   // It can't have taken longer than it's been since last frame started, some drivers get the first one wrong.
+                this->gpu = std::min(this->gpu, static_cast<float>((finished - this->previous).total_microseconds()) / 1000.0f);
+            }
+        }
+
+        return std::max(cpu, this->gpu);
+    }
+
+    if(!this->vsync && !this->previous.is_not_a_date_time())
+    {   // The last frame from start to start, including the swap, which waited for the GPU.
+        return std::max(cpu, static_cast<float>((this->started - this->previous).total_microseconds()) / 1000.0f);
+    }
+
+    return cpu;
+}
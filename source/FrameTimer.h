@@ -0,0 +1,76 @@
+/*!
+**  \file FrameTimer.h
+**  \brief Defines the FrameTimer class
+**
+**  \author Andrew James
+**  \sa FrameTimer
+*/
+#ifndef __FrameTimer
+#define __FrameTimer
+
+#include <SDL_OpenGL.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+/*!
+**  \class FrameTimer
+**  \brief Works out how long frames take, GPU included, without waiting on the GPU.
+**
+**  The drawing is bracketed by a timer query, and each query is read a frame later,
+**   once the GPU has got round to it, so a frame counts as the longer of the time the
+**   CPU spent on it and the time the GPU spent on the one before.
+**  Without timer queries it falls back on the time from the start of one frame to the
+**   start of the next, swap and all, which is only right if the swap doesn't wait for
+**   vsync. If vsync is on (or can't be ruled out) only the CPU time is counted.
+*/
+class FrameTimer
+{
+public:
+    /*!
+    **  \brief Creates the queries.
+    **
+    **  Must be created after the OpenGL context and GLExtensions::Load().
+    */
+    FrameTimer();
+
+    /*!
+    **  \brief Deletes the queries.
+    */
+    ~FrameTimer();
+
+    /*!
+    **  \brief Marks the start of a frame, call before anything else the frame does.
+    */
+    void Start();
+
+    /*!
+    **  \brief Marks the end of a frame, call once it's drawn and before the buffers are swapped.
+    **
+    **  \return How long the frame took, in milliseconds.
+    */
+    float Stop();
+
+protected:
+    const static int QUERIES;   //!< Queries in flight, one being written and one being read.
+
+    GLuint queries[2];          //!< The timer queries, used in turn (all 0 without timer queries).
+    bool pending[2];            //!< Has each query been ended and not read yet?
+    int current;                //!< The query for this frame.
+    float gpu;                  //!< GPU time of the last frame whose query has been read, in milliseconds.
+    bool vsync;                 //!< Might the swap wait for vsync?
+
+    boost::posix_time::ptime started;   //!< When this frame started.
+    boost::posix_time::ptime previous;  //!< When the frame before started (not_a_date_time for the first frame).
+
+private:
+    /*!
+    **  \brief Copy constructor is not allowed, the queries belong to one timer.
+    */
+    FrameTimer(const FrameTimer &rhs);
+
+    /*!
+    **  \brief Assignment operator is not allowed, the queries belong to one timer.
+    */
+    FrameTimer& operator=(const FrameTimer &rhs);
+};
+#endif
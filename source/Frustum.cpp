@@ -0,0 +1,67 @@
+#include "Frustum.h"
+
+Frustum::Frustum(void)
+{   // A plane of 0x + 0y + 0z + 1 has everything on the inside.
+    for(int i = 0; i < 6; ++i)
+    {
+        this->planes[i][0] = this->planes[i][1] = this->planes[i][2] = 0.0f;
+        this->planes[i][3] = 1.0f;
+    }
+}
+
+Frustum::Frustum(const Matrix4 &clip)
+{   // Row 3 plus or minus rows 0, 1 and 2 gives the left/right, bottom/top and near/far planes.
+    for(int i = 0; i < 6; ++i)
+    {
+        const int row = i / 2;
+        const float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+
+        for(int column = 0; column < 4; ++column)
+        {
+            this->planes[i][column] = clip.m[column * 4 + 3] + sign * clip.m[column * 4 + row];
+        }
+    }
+}
+
+void Frustum::Limit(const Vector3 &eye, const Vector3 &forward, const float &distance)
+{   // The far plane is the last one, inside is anything less than distance along forward from the eye.
+    this->planes[5][0] = -forward.x;
+    this->planes[5][1] = -forward.y;
+    this->planes[5][2] = -forward.z;
+    this->planes[5][3] = forward.Dot(eye) + distance;
+}
+
+Frustum::Result Frustum::Test(const BoundingBox &box) const
+{
+    if(box.Empty())
+    {
+        return OUTSIDE;
+    }
+
+    Result result = INSIDE;
+
+    for(int i = 0; i < 6; ++i)
+    {
+        const float *plane = this->planes[i];
+
+        // The corner furthest along the plane normal, and the corner furthest against it.
+        const Vector3 outer((plane[0] >= 0.0f) ? box.upper.x : box.lower.x,
+                          (plane[1] >= 0.0f) ? box.upper.y : box.lower.y,
+                          (plane[2] >= 0.0f) ? box.upper.z : box.lower.z);
+        const Vector3 inner((plane[0] >= 0.0f) ? box.lower.x : box.upper.x,
+                           (plane[1] >= 0.0f) ? box.lower.y : box.upper.y,
+                           (plane[2] >= 0.0f) ? box.lower.z : box.upper.z);
+
+        if(plane[0] * outer.x + plane[1] * outer.y + plane[2] * outer.z + plane[3] < 0.0f)
+        {   // Even the closest corner is on the wrong side.
+            return OUTSIDE;
+        }
+
+        if(plane[0] * inner.x + plane[1] * inner.y + plane[2] * inner.z + plane[3] < 0.0f)
+        {
+            result = INTERSECTS;
+        }
+    }
+
+    return result;
+}
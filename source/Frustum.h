@@ -0,0 +1,68 @@
+/*!
+**  \file Frustum.h
+**  \brief Defines the Frustum class
+**
+**  \author Andrew James
+**  \sa Frustum
+*/
+#ifndef __Frustum
+#define __Frustum
+
+#include "BoundingBox.h"
+#include "Matrix4.h"
+
+/*!
+**  \class Frustum
+**  \brief The six planes around what the camera can see, for skipping things that are off screen.
+**
+**  The planes are pulled straight out of the projection matrix times the view matrix (the
+**   Gribb/Hartmann trick), so they're in world space and always match what OpenGL draws.
+*/
+class Frustum
+{
+public:
+    /*!
+    **  \brief How much of a box is in the frustum.
+    */
+    enum Result
+    {
+        OUTSIDE,        //!< None of the box can be seen.
+        INTERSECTS,     //!< Some of the box might be seen.
+        INSIDE          //!< All of the box is in view.
+    };
+
+    /*!
+    **  \brief No args constructor creates a frustum that sees everything.
+    */
+    Frustum(void);
+
+    /*!
+    **  \brief Creates the frustum seen through the given matrix.
+    **
+    **  \param clip The projection matrix times the view matrix.
+    */
+    Frustum(const Matrix4 &clip);
+
+    /*!
+    **  \brief Checks how much of a box is in the frustum.
+    **
+    **  Conservative, a box near a corner of the frustum may be called INTERSECTS when it's
+    **   really just outside.
+    **  \param box The box to check (empty boxes are always OUTSIDE).
+    **  \return Where the box is.
+    */
+    Result Test(const BoundingBox &box) const;
+
+    /*!
+    **  \brief Pulls the far plane in.
+    **
+    **  \param eye Where the camera is.
+    **  \param forward The direction the camera is looking (unit length).
+    **  \param distance How far along forward the new far plane is.
+    */
+    void Limit(const Vector3 &eye, const Vector3 &forward, const float &distance);
+
+protected:
+    float planes[6][4];     //!< Each plane as (a, b, c, d), the inside is where ax + by + cz + d >= 0.
+};
+#endif
@@ -0,0 +1,83 @@
+#include "GLExtensions.h"
+
+#include <SDL.h>
+
+#include <cstring>
+#include <string>
+
+PFNGLGENBUFFERSPROC GLExtensions::glGenBuffers = 0;
+PFNGLDELETEBUFFERSPROC GLExtensions::glDeleteBuffers = 0;
+PFNGLBINDBUFFERPROC GLExtensions::glBindBuffer = 0;
+PFNGLBUFFERDATAPROC GLExtensions::glBufferData = 0;
+PFNGLBUFFERSUBDATAPROC GLExtensions::glBufferSubData = 0;
+PFNGLGENQUERIESPROC GLExtensions::glGenQueries = 0;
+PFNGLDELETEQUERIESPROC GLExtensions::glDeleteQueries = 0;
+PFNGLBEGINQUERYPROC GLExtensions::glBeginQuery = 0;
+PFNGLENDQUERYPROC GLExtensions::glEndQuery = 0;
+PFNGLGETQUERYOBJECTIVPROC GLExtensions::glGetQueryObjectiv = 0;
+PFNGLGETQUERYOBJECTUI64VEXTPROC GLExtensions::glGetQueryObjectui64v = 0;
+
+void GLExtensions::Load()
+{
+    glGenBuffers = reinterpret_cast<PFNGLGENBUFFERSPROC>(Find("glGenBuffers"));
+    glDeleteBuffers = reinterpret_cast<PFNGLDELETEBUFFERSPROC>(Find("glDeleteBuffers"));
+    glBindBuffer = reinterpret_cast<PFNGLBINDBUFFERPROC>(Find("glBindBuffer"));
+    glBufferData = reinterpret_cast<PFNGLBUFFERDATAPROC>(Find("glBufferData"));
+    glBufferSubData = reinterpret_cast<PFNGLBUFFERSUBDATAPROC>(Find("glBufferSubData"));
+    glGenQueries = reinterpret_cast<PFNGLGENQUERIESPROC>(Find("glGenQueries"));
+    glDeleteQueries = reinterpret_cast<PFNGLDELETEQUERIESPROC>(Find("glDeleteQueries"));
+    glBeginQuery = reinterpret_cast<PFNGLBEGINQUERYPROC>(Find("glBeginQuery"));
+    glEndQuery = reinterpret_cast<PFNGLENDQUERYPROC>(Find("glEndQuery"));
+    glGetQueryObjectiv = reinterpret_cast<PFNGLGETQUERYOBJECTIVPROC>(Find("glGetQueryObjectiv"));
+    glGetQueryObjectui64v = reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(Find("glGetQueryObjectui64v"));
+}
+
+bool GLExtensions::HasVertexBuffers()
+{
+    return glGenBuffers && glDeleteBuffers && glBindBuffer && glBufferData && glBufferSubData;
+}
+
+bool GLExtensions::HasTimerQueries()
+{   // Some drivers hand out pointers for anything, so the extension string has the last word.
+    return glGenQueries && glDeleteQueries && glBeginQuery && glEndQuery && glGetQueryObjectiv && glGetQueryObjectui64v &&
+           (Supports("GL_ARB_timer_query") || Supports("GL_EXT_timer_query"));
+}
+
+void* GLExtensions::Find(const char *name)
+{
+    if(void *function = SDL_GL_GetProcAddress(name))
+    {
+        return function;
+    }
+
+    // Older drivers only have the extension version.
+    if(void *function = SDL_GL_GetProcAddress((std::string(name) + "ARB").c_str()))
+    {
+        return function;
+    }
+
+    return SDL_GL_GetProcAddress((std::string(name) + "EXT").c_str());
+}
+
+bool GLExtensions::Supports(const char *name)
+{
+    const char *extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+
+    if(!extensions)
+    {
+        return false;
+    }
+
+    // Whole names only, GL_EXT_timer_query mustn't match GL_EXT_timer_query_something.
+    const std::size_t length = std::strlen(name);
+
+    for(const char *found = std::strstr(extensions, name); found; found = std::strstr(found + length, name))
+    {
+        if((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0'))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,74 @@
+/*!
+**  \file GLExtensions.h
+**  \brief Defines the GLExtensions class
+**
+**  \author Andrew James
+*/
+#ifndef __GLExtensions
+#define __GLExtensions
+
+#include <SDL_OpenGL.h>
+
+/*!
+**  \class GLExtensions
+**  \brief Loads the OpenGL functions newer than 1.1 that we use.
+**
+**  Windows only exports OpenGL 1.1 from OpenGL32.lib, anything newer has to be looked up
+**   at runtime once a context exists. Everything that uses these should check the
+**   matching Has*() function and fall back to plain 1.1 if it returns false.
+*/
+class GLExtensions
+{
+public:
+    /*!
+    **  \brief Looks up the function pointers.
+    **
+    **  Must be called after the OpenGL context has been created (after SDL_SetVideoMode).
+    */
+    static void Load();
+
+    /*!
+    **  \brief Checks if vertex buffer objects are available (OpenGL 1.5 or GL_ARB_vertex_buffer_object).
+    **
+    **  \return Returns true if all the buffer functions were found.
+    */
+    static bool HasVertexBuffers();
+
+    /*!
+    **  \brief Checks if timer queries are available (GL_EXT_timer_query or GL_ARB_timer_query).
+    **
+    **  \return Returns true if the extension is there and all the query functions were found.
+    */
+    static bool HasTimerQueries();
+
+    static PFNGLGENBUFFERSPROC glGenBuffers;        //!< Creates buffer objects.
+    static PFNGLDELETEBUFFERSPROC glDeleteBuffers;  //!< Deletes buffer objects.
+    static PFNGLBINDBUFFERPROC glBindBuffer;        //!< Binds a buffer object.
+    static PFNGLBUFFERDATAPROC glBufferData;        //!< (Re)allocates and fills a buffer object.
+    static PFNGLBUFFERSUBDATAPROC glBufferSubData;  //!< Updates part of a buffer object.
+
+    static PFNGLGENQUERIESPROC glGenQueries;                        //!< Creates query objects.
+    static PFNGLDELETEQUERIESPROC glDeleteQueries;                  //!< Deletes query objects.
+    static PFNGLBEGINQUERYPROC glBeginQuery;                        //!< Starts a query.
+    static PFNGLENDQUERYPROC glEndQuery;                            //!< Ends a query.
+    static PFNGLGETQUERYOBJECTIVPROC glGetQueryObjectiv;            //!< Checks if a query's result is ready.
+    static PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64v;   //!< Reads a query's 64 bit result.
+
+protected:
+    /*!
+    **  \brief Looks up a function, trying the core name then the ARB and EXT names.
+    **
+    **  \param name The core name of the function.
+    **  \return The function, or 0 if neither name was found.
+    */
+    static void* Find(const char *name);
+
+    /*!
+    **  \brief Checks if the driver lists an extension.
+    **
+    **  \param name The name of the extension.
+    **  \return Returns true if it's in the extension string.
+    */
+    static bool Supports(const char *name);
+};
+#endif
@@ -0,0 +1,59 @@
+#include "Governor.h"
+
+const int Governor::LEVELS = 6;
+const float Governor::QUALITY[] = {1.0f, 0.5f, 0.25f, 0.125f, 0.0625f, 0.03125f};
+const float Governor::REACH[] = {1024.0f, 1024.0f, 768.0f, 512.0f, 384.0f, 256.0f};
+const float Governor::SMOOTHING = 0.1f;
+const float Governor::SLACK = 0.75f;
+const int Governor::SETTLE = 30;
+
+Governor::Governor(const float &budget):budget(budget),average(0.0f),level(0),wait(SETTLE)
+{
+}
+
+void Governor::Frame(const float &milliseconds)
+{
+    this->average += (milliseconds - this->average) * SMOOTHING;
+
+    if(this->wait > 0)
+    {   // Still waiting for the average to catch up with the last step.
+        --this->wait;
+        return;
+    }
+
+    if(this->average > this->budget && this->level < LEVELS - 1)
+    {
+        ++this->level;
+        this->wait = SETTLE;
+    }
+    else if(this->average < this->budget * SLACK && this->level > 0)
+    {
+        --this->level;
+        this->wait = SETTLE;
+    }
+}
+
+float Governor::Quality() const
+{
+    return QUALITY[this->level];
+}
+
+float Governor::Reach() const
+{
+    return REACH[this->level];
+}
+
+int Governor::Level() const
+{
+    return this->level;
+}
+
+float Governor::Average() const
+{
+    return this->average;
+}
+
+float Governor::Budget() const
+{
+    return this->budget;
+}
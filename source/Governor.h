@@ -0,0 +1,88 @@
+/*!
+**  \file Governor.h
+**  \brief Defines the Governor class
+**
+**  \author Andrew James
+**  \sa Governor
+*/
+#ifndef __Governor
+#define __Governor
+
+/*!
+**  \class Governor
+**  \brief Trades away detail and draw distance to keep frames inside a time budget.
+**
+**  Fed the time each frame took, it keeps a smoothed average and steps between a handful
+**   of levels. Level 0 is everything at full quality, each level after it switches to low
+**   detail sooner (see Detail) and culls closer in (see Frustum::Limit()) than the last.
+**  It steps down a level when the average goes over the budget, and back up only once the
+**   average is comfortably under it, waiting a few frames after every step so the average
+**   catches up before it decides again.
+*/
+class Governor
+{
+public:
+    const static int LEVELS;    //!< Number of levels.
+
+    /*!
+    **  \brief Creates a governor at full quality.
+    **
+    **  \param budget How long a frame should take, in milliseconds.
+    */
+    Governor(const float &budget);
+
+    /*!
+    **  \brief Records how long a frame took, and steps to a new level if need be.
+    **
+    **  \param milliseconds How long the frame took.
+    */
+    void Frame(const float &milliseconds);
+
+    /*!
+    **  \brief Returns how much to scale the pixel size used by Detail.
+    **
+    **  \return 1 at full quality, less than that to switch to low detail sooner.
+    */
+    float Quality() const;
+
+    /*!
+    **  \brief Returns how far away things can be and still get drawn.
+    **
+    **  \return The distance in world units.
+    */
+    float Reach() const;
+
+    /*!
+    **  \brief Returns the current level.
+    **
+    **  \return The level, 0 for full quality up to LEVELS - 1.
+    */
+    int Level() const;
+
+    /*!
+    **  \brief Returns the smoothed frame time.
+    **
+    **  \return The average in milliseconds.
+    */
+    float Average() const;
+
+    /*!
+    **  \brief Returns the budget.
+    **
+    **  \return How long a frame should take, in milliseconds.
+    */
+    float Budget() const;
+
+protected:
+    const static float QUALITY[];   //!< Quality() at each level.
+    const static float REACH[];     //!< Reach() at each level.
+    const static float SMOOTHING;   //!< How much of each new frame time goes into the average.
+    const static float SLACK;       //!< Fraction of the budget the average has to be under to step back up.
+    const static int SETTLE;        //!< Frames to wait after stepping before stepping again.
+
+    float budget;   //!< How long a frame should take, in milliseconds.
+    float average;  //!< Smoothed frame time, in milliseconds.
+    int level;      //!< The current level.
+    int wait;       //!< Frames left before the level can change again.
+};
+#endif
@@ -0,0 +1,162 @@
+#include "JobPool.h"
+
+#include <boost/bind.hpp>
+
+JobPool::JobPool(const unsigned int &threads):queues(),mutex(),pending(),finished(),waiting(0),available(0),outstanding(0),next(0),running(true),workers()
+{
+    for(unsigned int i = 0; i <= threads; ++i)
+    {
+        this->queues.push_back(boost::shared_ptr<Queue>(new Queue()));
+    }
+
+    for(unsigned int i = 0; i < threads; ++i)
+    {
+        this->workers.create_thread(boost::bind(&JobPool::Run, this, static_cast<std::size_t>(i)));
+    }
+}
+
+JobPool::~JobPool()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(this->mutex);
+        this->running = false;
+    }
+
+    this->pending.notify_all();
+    this->workers.join_all();
+}
+
+void JobPool::Add(const Job &job)
+{
+    std::size_t queue;
+    bool wake;
+
+    {   // Counted before it's queued, so a thread that takes it can never count it off first.
+        boost::lock_guard<boost::mutex> lock(this->mutex);
+
+        ++this->available;
+        ++this->outstanding;
+
+        queue = this->next;
+        this->next = (this->next + 1) % this->queues.size();
+
+        wake = this->waiting > 0;
+    }
+
+    {
+        boost::lock_guard<boost::mutex> lock(this->queues[queue]->mutex);
+        this->queues[queue]->jobs.push_back(job);
+    }
+
+    this->pending.notify_one();
+
+    if(wake)
+    {   // Someone in Wait() ran out of jobs, give them this one to help with.
+        this->finished.notify_all();
+    }
+}
+
+void JobPool::Wait()
+{
+    const std::size_t self = this->queues.size() - 1;
+    Job job;
+
+    while(true)
+    {
+        if(Take(self, job))
+        {
+            Execute(job);
+            continue;
+        }
+
+        // Nothing left to take, but the workers may still be running the last few.
+        boost::unique_lock<boost::mutex> lock(this->mutex);
+
+        if(this->outstanding == 0)
+        {
+            return;
+        }
+
+        if(this->available == 0)
+        {   // Sleep until there's something to help with, or it's all done.
+            ++this->waiting;
+            this->finished.wait(lock);
+            --this->waiting;
+        }
+    }
+}
+
+std::size_t JobPool::Threads() const
+{
+    return this->queues.size();
+}
+
+void JobPool::Run(const std::size_t &self)
+{
+    Job job;
+
+    while(true)
+    {
+        if(Take(self, job))
+        {
+            Execute(job);
+            continue;
+        }
+
+        boost::unique_lock<boost::mutex> lock(this->mutex);
+
+        while(this->running && this->available == 0)
+        {
+            this->pending.wait(lock);
+        }
+
+        if(!this->running)
+        {
+            return;
+        }
+    }
+}
+
+bool JobPool::Take(const std::size_t &self, Job &job)
+{
+    for(std::size_t i = 0; i < this->queues.size(); ++i)
+    {   // Our own queue first, then the others starting with our neighbour.
+        Queue &queue = *this->queues[(self + i) % this->queues.size()];
+        boost::lock_guard<boost::mutex> lock(queue.mutex);
+
+        if(queue.jobs.empty())
+        {
+            continue;
+        }
+
+        if(i == 0)
+        {   // The newest job in our own queue is the one most likely to still be in the cache.
+            job = queue.jobs.back();
+            queue.jobs.pop_back();
+        }
+        else
+        {   // Thieves take the oldest, which tend to be the biggest.
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+        }
+
+        boost::lock_guard<boost::mutex> count(this->mutex);
+        --this->available;
+
+        return true;
+    }
+
+    return false;
+}
+
+void JobPool::Execute(const Job &job)
+{
+    job();
+
+    boost::lock_guard<boost::mutex> lock(this->mutex);
+
+    if(--this->outstanding == 0)
+    {
+        this->finished.notify_all();
+    }
+}
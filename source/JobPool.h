@@ -0,0 +1,123 @@
+/*!
+**  \file JobPool.h
+**  \brief Defines the JobPool class
+**
+**  \author Andrew James
+**  \sa JobPool
+*/
+#ifndef __JobPool
+#define __JobPool
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+/*!
+**  \class JobPool
+**  \brief Runs small jobs on a set of worker threads that steal work from each other.
+**
+**  Every thread (the workers, plus whoever calls Wait()) has its own queue. Jobs are dealt
+**   out round robin, a thread works from the back of its own queue and, once that's empty,
+**   steals from the front of the others. Jobs can add more jobs, so one big job can split
+**   itself up and let the idle threads take the pieces.
+**  Each queue has its own lock, so threads only get in each other's way when stealing.
+*/
+class JobPool
+{
+public:
+    typedef boost::function<void ()> Job;   //!< Something to do.
+
+    /*!
+    **  \brief Creates the pool and starts the workers.
+    **
+    **  \param threads How many worker threads to start, the thread that calls Wait() makes one more.
+    */
+    JobPool(const unsigned int &threads);
+
+    /*!
+    **  \brief Stops the workers, anything still queued is dropped.
+    */
+    ~JobPool();
+
+    /*!
+    **  \brief Queues a job. Can be called from any thread, including from inside a job.
+    **
+    **  \param job The job to run.
+    */
+    void Add(const Job &job);
+
+    /*!
+    **  \brief Helps run the queued jobs until every one of them (and any they add) is done.
+    */
+    void Wait();
+
+    /*!
+    **  \brief Returns the number of threads that run jobs.
+    **
+    **  \return The number of workers, plus one for the thread that calls Wait().
+    */
+    std::size_t Threads() const;
+
+protected:
+    /*!
+    **  \struct Queue
+    **  \brief The jobs waiting on one thread.
+    */
+    struct Queue
+    {
+        boost::mutex mutex;         //!< Guards the jobs.
+        std::deque<Job> jobs;       //!< The jobs, the owner takes from the back and thieves from the front.
+    };
+
+    std::vector<boost::shared_ptr<Queue> > queues;  //!< One queue per worker, then one for the thread that calls Wait().
+
+    boost::mutex mutex;                     //!< Guards the counts, next and the running flag.
+    boost::condition_variable pending;      //!< Signalled when a job is added (or we're shutting down).
+    boost::condition_variable finished;     //!< Signalled for Wait() when a job is added or the last outstanding job finishes.
+    std::size_t waiting;                    //!< Threads asleep in Wait(), so Add() only signals finished when someone's listening.
+    std::size_t available;                  //!< Jobs sitting in the queues.
+    std::size_t outstanding;                //!< Jobs added but not finished yet.
+    std::size_t next;                       //!< Queue that gets the next job.
+    bool running;                           //!< Set to false to stop the workers.
+
+    boost::thread_group workers;            //!< The worker threads (declared last so they start last).
+
+    /*!
+    **  \brief Worker thread loop, runs jobs until told to stop.
+    **
+    **  \param self The worker's queue.
+    */
+    void Run(const std::size_t &self);
+
+    /*!
+    **  \brief Takes a job from a thread's own queue, or steals one from another.
+    **
+    **  \param self The thread's queue.
+    **  \param job Set to the job.
+    **  \return Returns true if a job was found.
+    */
+    bool Take(const std::size_t &self, Job &job);
+
+    /*!
+    **  \brief Runs a job and counts it off.
+    **
+    **  \param job The job to run.
+    */
+    void Execute(const Job &job);
+
+private:
+    /*!
+    **  \brief Copy constructor is not allowed, the workers belong to one pool.
+    */
+    JobPool(const JobPool &rhs);
+
+    /*!
+    **  \brief Assignment operator is not allowed, the workers belong to one pool.
+    */
+    JobPool& operator=(const JobPool &rhs);
+};
+#endif
@@ -0,0 +1,274 @@
+#include "Matrix4.h"
+
+#include "Simd.h"
+
+#include <cmath>
+
+const float Matrix4::sines[720] =
+{   // sin(0) to sin(359.5 degrees) in half degrees, rounded from double precision.
+             0.0f,  0.008726535f,  0.017452406f,  0.026176948f,  0.034899496f,  0.043619387f,  0.052335955f,   0.06104854f,
+      0.06975647f,    0.0784591f,  0.087155744f,   0.09584575f,  0.104528464f,   0.11320321f,   0.12186934f,   0.13052619f,
+       0.1391731f,   0.14780942f,   0.15643446f,    0.1650476f,   0.17364818f,   0.18223552f,     0.190809f,   0.19936794f,
+      0.20791169f,   0.21643962f,   0.22495106f,   0.23344536f,    0.2419219f,      0.25038f,   0.25881904f,   0.26723838f,
+      0.27563736f,   0.28401536f,    0.2923717f,    0.3007058f,     0.309017f,   0.31730467f,   0.32556817f,   0.33380687f,
+      0.34202015f,    0.3502074f,   0.35836795f,    0.3665012f,   0.37460658f,   0.38268343f,   0.39073113f,   0.39874908f,
+      0.40673664f,   0.41469324f,   0.42261827f,    0.4305111f,   0.43837115f,    0.4461978f,    0.4539905f,    0.4617486f,
+      0.46947157f,   0.47715876f,    0.4848096f,   0.49242356f,          0.5f,    0.5075384f,    0.5150381f,   0.52249855f,
+      0.52991927f,   0.53729963f,   0.54463905f,     0.551937f,    0.5591929f,   0.56640625f,   0.57357645f,   0.58070296f,
+      0.58778524f,   0.59482276f,   0.60181504f,    0.6087614f,    0.6156615f,   0.62251467f,    0.6293204f,   0.63607824f,
+      0.64278764f,   0.64944804f,     0.656059f,   0.66262007f,    0.6691306f,    0.6755902f,    0.6819984f,   0.68835455f,
+       0.6946584f,   0.70090926f,   0.70710677f,   0.71325046f,    0.7193398f,    0.7253744f,    0.7313537f,    0.7372773f,
+       0.7431448f,    0.7489557f,    0.7547096f,   0.76040596f,   0.76604444f,   0.77162457f,     0.777146f,   0.78260815f,
+       0.7880108f,    0.7933533f,    0.7986355f,   0.80385685f,     0.809017f,    0.8141155f,   0.81915206f,    0.8241262f,
+      0.82903755f,   0.83388585f,   0.83867055f,    0.8433914f,    0.8480481f,   0.85264015f,    0.8571673f,    0.8616292f,
+       0.8660254f,    0.8703557f,    0.8746197f,   0.87881714f,   0.88294756f,    0.8870108f,    0.8910065f,   0.89493436f,
+      0.89879405f,   0.90258527f,    0.9063078f,    0.9099613f,    0.9135454f,    0.9170601f,   0.92050487f,    0.9238795f,
+      0.92718387f,    0.9304176f,    0.9335804f,    0.9366722f,    0.9396926f,    0.9426415f,   0.94551855f,   0.94832367f,
+      0.95105654f,   0.95371693f,    0.9563047f,   0.95881975f,    0.9612617f,   0.96363044f,    0.9659258f,   0.96814764f,
+       0.9702957f,    0.9723699f,   0.97437006f,     0.976296f,    0.9781476f,    0.9799247f,   0.98162717f,    0.9832549f,
+       0.9848077f,    0.9862856f,   0.98768836f,    0.9890159f,   0.99026805f,    0.9914449f,   0.99254614f,    0.9935719f,
+       0.9945219f,    0.9953962f,    0.9961947f,    0.9969173f,    0.9975641f,    0.9981348f,    0.9986295f,   0.99904823f,
+      0.99939084f,   0.99965733f,    0.9998477f,    0.9999619f,          1.0f,    0.9999619f,    0.9998477f,   0.99965733f,
+      0.99939084f,   0.99904823f,    0.9986295f,    0.9981348f,    0.9975641f,    0.9969173f,    0.9961947f,    0.9953962f,
+       0.9945219f,    0.9935719f,   0.99254614f,    0.9914449f,   0.99026805f,    0.9890159f,   0.98768836f,    0.9862856f,
+       0.9848077f,    0.9832549f,   0.98162717f,    0.9799247f,    0.9781476f,     0.976296f,   0.97437006f,    0.9723699f,
+       0.9702957f,   0.96814764f,    0.9659258f,   0.96363044f,    0.9612617f,   0.95881975f,    0.9563047f,   0.95371693f,
+      0.95105654f,   0.94832367f,   0.94551855f,    0.9426415f,    0.9396926f,    0.9366722f,    0.9335804f,    0.9304176f,
+      0.92718387f,    0.9238795f,   0.92050487f,    0.9170601f,    0.9135454f,    0.9099613f,    0.9063078f,   0.90258527f,
+      0.89879405f,   0.89493436f,    0.8910065f,    0.8870108f,   0.88294756f,   0.87881714f,    0.8746197f,    0.8703557f,
+       0.8660254f,    0.8616292f,    0.8571673f,   0.85264015f,    0.8480481f,    0.8433914f,   0.83867055f,   0.83388585f,
+      0.82903755f,    0.8241262f,   0.81915206f,    0.8141155f,     0.809017f,   0.80385685f,    0.7986355f,    0.7933533f,
+       0.7880108f,   0.78260815f,     0.777146f,   0.77162457f,   0.76604444f,   0.76040596f,    0.7547096f,    0.7489557f,
+       0.7431448f,    0.7372773f,    0.7313537f,    0.7253744f,    0.7193398f,   0.71325046f,   0.70710677f,   0.70090926f,
+       0.6946584f,   0.68835455f,    0.6819984f,    0.6755902f,    0.6691306f,   0.66262007f,     0.656059f,   0.64944804f,
+      0.64278764f,   0.63607824f,    0.6293204f,   0.62251467f,    0.6156615f,    0.6087614f,   0.60181504f,   0.59482276f,
+      0.58778524f,   0.58070296f,   0.57357645f,   0.56640625f,    0.5591929f,     0.551937f,   0.54463905f,   0.53729963f,
+      0.52991927f,   0.52249855f,    0.5150381f,    0.5075384f,          0.5f,   0.49242356f,    0.4848096f,   0.47715876f,
+      0.46947157f,    0.4617486f,    0.4539905f,    0.4461978f,   0.43837115f,    0.4305111f,   0.42261827f,   0.41469324f,
+      0.40673664f,   0.39874908f,   0.39073113f,   0.38268343f,   0.37460658f,    0.3665012f,   0.35836795f,    0.3502074f,
+      0.34202015f,   0.33380687f,   0.32556817f,   0.31730467f,     0.309017f,    0.3007058f,    0.2923717f,   0.28401536f,
+      0.27563736f,   0.26723838f,   0.25881904f,      0.25038f,    0.2419219f,   0.23344536f,   0.22495106f,   0.21643962f,
+      0.20791169f,   0.19936794f,     0.190809f,   0.18223552f,   0.17364818f,    0.1650476f,   0.15643446f,   0.14780942f,
+       0.1391731f,   0.13052619f,   0.12186934f,   0.11320321f,  0.104528464f,   0.09584575f,  0.087155744f,    0.0784591f,
+      0.06975647f,   0.06104854f,  0.052335955f,  0.043619387f,  0.034899496f,  0.026176948f,  0.017452406f,  0.008726535f,
+             0.0f, -0.008726535f, -0.017452406f, -0.026176948f, -0.034899496f, -0.043619387f, -0.052335955f,  -0.06104854f,
+     -0.06975647f,   -0.0784591f, -0.087155744f,  -0.09584575f, -0.104528464f,  -0.11320321f,  -0.12186934f,  -0.13052619f,
+      -0.1391731f,  -0.14780942f,  -0.15643446f,   -0.1650476f,  -0.17364818f,  -0.18223552f,    -0.190809f,  -0.19936794f,
+     -0.20791169f,  -0.21643962f,  -0.22495106f,  -0.23344536f,   -0.2419219f,     -0.25038f,  -0.25881904f,  -0.26723838f,
+     -0.27563736f,  -0.28401536f,   -0.2923717f,   -0.3007058f,    -0.309017f,  -0.31730467f,  -0.32556817f,  -0.33380687f,
+     -0.34202015f,   -0.3502074f,  -0.35836795f,   -0.3665012f,  -0.37460658f,  -0.38268343f,  -0.39073113f,  -0.39874908f,
+     -0.40673664f,  -0.41469324f,  -0.42261827f,   -0.4305111f,  -0.43837115f,   -0.4461978f,   -0.4539905f,   -0.4617486f,
+     -0.46947157f,  -0.47715876f,   -0.4848096f,  -0.49242356f,         -0.5f,   -0.5075384f,   -0.5150381f,  -0.52249855f,
+     -0.52991927f,  -0.53729963f,  -0.54463905f,    -0.551937f,   -0.5591929f,  -0.56640625f,  -0.57357645f,  -0.58070296f,
+     -0.58778524f,  -0.59482276f,  -0.60181504f,   -0.6087614f,   -0.6156615f,  -0.62251467f,   -0.6293204f,  -0.63607824f,
+     -0.64278764f,  -0.64944804f,    -0.656059f,  -0.66262007f,   -0.6691306f,   -0.6755902f,   -0.6819984f,  -0.68835455f,
+      -0.6946584f,  -0.70090926f,  -0.70710677f,  -0.71325046f,   -0.7193398f,   -0.7253744f,   -0.7313537f,   -0.7372773f,
+      -0.7431448f,   -0.7489557f,   -0.7547096f,  -0.76040596f,  -0.76604444f,  -0.77162457f,    -0.777146f,  -0.78260815f,
+      -0.7880108f,   -0.7933533f,   -0.7986355f,  -0.80385685f,    -0.809017f,   -0.8141155f,  -0.81915206f,   -0.8241262f,
+     -0.82903755f,  -0.83388585f,  -0.83867055f,   -0.8433914f,   -0.8480481f,  -0.85264015f,   -0.8571673f,   -0.8616292f,
+      -0.8660254f,   -0.8703557f,   -0.8746197f,  -0.87881714f,  -0.88294756f,   -0.8870108f,   -0.8910065f,  -0.89493436f,
+     -0.89879405f,  -0.90258527f,   -0.9063078f,   -0.9099613f,   -0.9135454f,   -0.9170601f,  -0.92050487f,   -0.9238795f,
+     -0.92718387f,   -0.9304176f,   -0.9335804f,   -0.9366722f,   -0.9396926f,   -0.9426415f,  -0.94551855f,  -0.94832367f,
+     -0.95105654f,  -0.95371693f,   -0.9563047f,  -0.95881975f,   -0.9612617f,  -0.96363044f,   -0.9659258f,  -0.96814764f,
+      -0.9702957f,   -0.9723699f,  -0.97437006f,    -0.976296f,   -0.9781476f,   -0.9799247f,  -0.98162717f,   -0.9832549f,
+      -0.9848077f,   -0.9862856f,  -0.98768836f,   -0.9890159f,  -0.99026805f,   -0.9914449f,  -0.99254614f,   -0.9935719f,
+      -0.9945219f,   -0.9953962f,   -0.9961947f,   -0.9969173f,   -0.9975641f,   -0.9981348f,   -0.9986295f,  -0.99904823f,
+     -0.99939084f,  -0.99965733f,   -0.9998477f,   -0.9999619f,         -1.0f,   -0.9999619f,   -0.9998477f,  -0.99965733f,
+     -0.99939084f,  -0.99904823f,   -0.9986295f,   -0.9981348f,   -0.9975641f,   -0.9969173f,   -0.9961947f,   -0.9953962f,
+      -0.9945219f,   -0.9935719f,  -0.99254614f,   -0.9914449f,  -0.99026805f,   -0.9890159f,  -0.98768836f,   -0.9862856f,
+      -0.9848077f,   -0.9832549f,  -0.98162717f,   -0.9799247f,   -0.9781476f,    -0.976296f,  -0.97437006f,   -0.9723699f,
+      -0.9702957f,  -0.96814764f,   -0.9659258f,  -0.96363044f,   -0.9612617f,  -0.95881975f,   -0.9563047f,  -0.95371693f,
+     -0.95105654f,  -0.94832367f,  -0.94551855f,   -0.9426415f,   -0.9396926f,   -0.9366722f,   -0.9335804f,   -0.9304176f,
+     -0.92718387f,   -0.9238795f,  -0.92050487f,   -0.9170601f,   -0.9135454f,   -0.9099613f,   -0.9063078f,  -0.90258527f,
+     -0.89879405f,  -0.89493436f,   -0.8910065f,   -0.8870108f,  -0.88294756f,  -0.87881714f,   -0.8746197f,   -0.8703557f,
+      -0.8660254f,   -0.8616292f,   -0.8571673f,  -0.85264015f,   -0.8480481f,   -0.8433914f,  -0.83867055f,  -0.83388585f,
+     -0.82903755f,   -0.8241262f,  -0.81915206f,   -0.8141155f,    -0.809017f,  -0.80385685f,   -0.7986355f,   -0.7933533f,
+      -0.7880108f,  -0.78260815f,    -0.777146f,  -0.77162457f,  -0.76604444f,  -0.76040596f,   -0.7547096f,   -0.7489557f,
+      -0.7431448f,   -0.7372773f,   -0.7313537f,   -0.7253744f,   -0.7193398f,  -0.71325046f,  -0.70710677f,  -0.70090926f,
+      -0.6946584f,  -0.68835455f,   -0.6819984f,   -0.6755902f,   -0.6691306f,  -0.66262007f,    -0.656059f,  -0.64944804f,
+     -0.64278764f,  -0.63607824f,   -0.6293204f,  -0.62251467f,   -0.6156615f,   -0.6087614f,  -0.60181504f,  -0.59482276f,
+     -0.58778524f,  -0.58070296f,  -0.57357645f,  -0.56640625f,   -0.5591929f,    -0.551937f,  -0.54463905f,  -0.53729963f,
+     -0.52991927f,  -0.52249855f,   -0.5150381f,   -0.5075384f,         -0.5f,  -0.49242356f,   -0.4848096f,  -0.47715876f,
+     -0.46947157f,   -0.4617486f,   -0.4539905f,   -0.4461978f,  -0.43837115f,   -0.4305111f,  -0.42261827f,  -0.41469324f,
+     -0.40673664f,  -0.39874908f,  -0.39073113f,  -0.38268343f,  -0.37460658f,   -0.3665012f,  -0.35836795f,   -0.3502074f,
+     -0.34202015f,  -0.33380687f,  -0.32556817f,  -0.31730467f,    -0.309017f,   -0.3007058f,   -0.2923717f,  -0.28401536f,
+     -0.27563736f,  -0.26723838f,  -0.25881904f,     -0.25038f,   -0.2419219f,  -0.23344536f,  -0.22495106f,  -0.21643962f,
+     -0.20791169f,  -0.19936794f,    -0.190809f,  -0.18223552f,  -0.17364818f,   -0.1650476f,  -0.15643446f,  -0.14780942f,
+      -0.1391731f,  -0.13052619f,  -0.12186934f,  -0.11320321f, -0.104528464f,  -0.09584575f, -0.087155744f,   -0.0784591f,
+     -0.06975647f,  -0.06104854f, -0.052335955f, -0.043619387f, -0.034899496f, -0.026176948f, -0.017452406f, -0.008726535f,
+};
+
+Matrix4::Matrix4(void)
+{
+    for(int i = 0; i < 16; ++i)
+    {
+        this->m[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    }
+}
+
+Matrix4::Matrix4(const float *m)
+{
+    for(int i = 0; i < 16; ++i)
+    {
+        this->m[i] = m[i];
+    }
+}
+
+Matrix4& Matrix4::operator*=(const Matrix4 &rhs)
+{
+    *this = *this * rhs;
+
+    return *this;
+}
+
+const Matrix4 Matrix4::operator*(const Matrix4 &rhs) const
+{
+    Matrix4 result;
+    const Simd::Float4 columns[4] = { Simd::LoadUnaligned(this->m), Simd::LoadUnaligned(this->m + 4),
+                                      Simd::LoadUnaligned(this->m + 8), Simd::LoadUnaligned(this->m + 12) };
+
+    for(int column = 0; column < 4; ++column)
+    {   // Each column of the result is the columns of this weighted by a column of rhs.
+        const float *weights = rhs.m + column * 4;
+
+        Simd::StoreUnaligned(result.m + column * 4, Simd::Add(Simd::Add(Simd::Mul(columns[0], Simd::Splat(weights[0])), Simd::Mul(columns[1], Simd::Splat(weights[1]))),
+                                                              Simd::Add(Simd::Mul(columns[2], Simd::Splat(weights[2])), Simd::Mul(columns[3], Simd::Splat(weights[3])))));
+    }
+
+    return result;
+}
+
+const Vector3 Matrix4::TransformPoint(const Vector3 &point) const
+{
+    return Vector3(this->m[0] * point.x + this->m[4] * point.y + this->m[8] * point.z + this->m[12],
+                   this->m[1] * point.x + this->m[5] * point.y + this->m[9] * point.z + this->m[13],
+                   this->m[2] * point.x + this->m[6] * point.y + this->m[10] * point.z + this->m[14]);
+}
+
+const Vector3 Matrix4::TransformVector(const Vector3 &direction) const
+{
+    return Vector3(this->m[0] * direction.x + this->m[4] * direction.y + this->m[8] * direction.z,
+                   this->m[1] * direction.x + this->m[5] * direction.y + this->m[9] * direction.z,
+                   this->m[2] * direction.x + this->m[6] * direction.y + this->m[10] * direction.z);
+}
+
+const Matrix4 Matrix4::RigidInverse() const
+{
+    Matrix4 result;
+
+    for(int column = 0; column < 3; ++column)
+    {
+        for(int row = 0; row < 3; ++row)
+        {
+            result.m[column * 4 + row] = this->m[row * 4 + column];
+        }
+
+        result.m[12 + column] = -(this->m[column * 4] * this->m[12] + this->m[column * 4 + 1] * this->m[13] + this->m[column * 4 + 2] * this->m[14]);
+    }
+
+    return result;
+}
+
+const Quaternion Matrix4::ToQuaternion() const
+{   // Divide by whichever of w, x, y or z is biggest, so nothing gets lost dividing by a tiny one.
+    float trace = this->m[0] + this->m[5] + this->m[10];
+
+    if(trace > 0.0f)
+    {
+        float s = sqrt(trace + 1.0f) * 2.0f;
+        return Quaternion(0.25f * s, Vector3(this->m[6] - this->m[9], this->m[8] - this->m[2], this->m[1] - this->m[4]) / s);
+    }
+    else if(this->m[0] > this->m[5] && this->m[0] > this->m[10])
+    {
+        float s = sqrt(1.0f + this->m[0] - this->m[5] - this->m[10]) * 2.0f;
+        return Quaternion((this->m[6] - this->m[9]) / s, Vector3(0.25f * s, (this->m[1] + this->m[4]) / s, (this->m[8] + this->m[2]) / s));
+    }
+    else if(this->m[5] > this->m[10])
+    {
+        float s = sqrt(1.0f + this->m[5] - this->m[0] - this->m[10]) * 2.0f;
+        return Quaternion((this->m[8] - this->m[2]) / s, Vector3((this->m[1] + this->m[4]) / s, 0.25f * s, (this->m[6] + this->m[9]) / s));
+    }
+
+    float s = sqrt(1.0f + this->m[10] - this->m[0] - this->m[5]) * 2.0f;
+    return Quaternion((this->m[1] - this->m[4]) / s, Vector3((this->m[8] + this->m[2]) / s, (this->m[6] + this->m[9]) / s, 0.25f * s));
+}
+
+const Matrix4 Matrix4::Translation(const Vector3 &offset)
+{
+    Matrix4 result;
+
+    result.m[12] = offset.x;
+    result.m[13] = offset.y;
+    result.m[14] = offset.z;
+
+    return result;
+}
+
+const Matrix4 Matrix4::Rotation(const Vector3 &axis, const float &degrees)
+{
+    Matrix4 result;
+
+    if(axis.Norm() == 0.0f)
+    {   // glRotatef does nothing with a null axis, neither do we.
+        return result;
+    }
+
+    Vector3 n = Vector3(axis).Normalise();
+    float c, s;
+    SinCos(degrees, s, c);
+    float t = 1.0f - c;
+
+    result.m[0] = n.x * n.x * t + c;
+    result.m[1] = n.y * n.x * t + n.z * s;
+    result.m[2] = n.x * n.z * t - n.y * s;
+    //------------------
+    result.m[4] = n.x * n.y * t - n.z * s;
+    result.m[5] = n.y * n.y * t + c;
+    result.m[6] = n.y * n.z * t + n.x * s;
+    //------------------
+    result.m[8] = n.x * n.z * t + n.y * s;
+    result.m[9] = n.y * n.z * t - n.x * s;
+    result.m[10] = n.z * n.z * t + c;
+
+    return result;
+}
+
+const Matrix4 Matrix4::FromQuaternion(const Quaternion &rotation)
+{
+    Matrix4 result;
+    const float w = rotation.w, x = rotation.xyz.x, y = rotation.xyz.y, z = rotation.xyz.z;
+
+    result.m[0] = 1.0f - 2.0f * (y * y + z * z);
+    result.m[1] = 2.0f * (x * y + w * z);
+    result.m[2] = 2.0f * (x * z - w * y);
+    //------------------
+    result.m[4] = 2.0f * (x * y - w * z);
+    result.m[5] = 1.0f - 2.0f * (x * x + z * z);
+    result.m[6] = 2.0f * (y * z + w * x);
+    //------------------
+    result.m[8] = 2.0f * (x * z + w * y);
+    result.m[9] = 2.0f * (y * z - w * x);
+    result.m[10] = 1.0f - 2.0f * (x * x + y * y);
+
+    return result;
+}
+
+void Matrix4::SinCos(const float &degrees, float &sine, float &cosine)
+{
+    float halves = degrees * 2.0f;
+
+    if(halves == floor(halves) && fabs(halves) < 16777216.0f)
+    {   // Every half degree is in the table, and cos is just sin a quarter turn on.
+        int index = static_cast<int>(halves) % 720;
+        index += (index < 0) ? 720 : 0;
+
+        sine = sines[index];
+        cosine = sines[(index + 180) % 720];
+
+        return;
+    }
+
+    float radians = Quaternion::DegreesToRadians(degrees);
+    sine = sin(radians);
+    cosine = cos(radians);
+}
@@ -0,0 +1,132 @@
+/*!
+**  \file Matrix4.h
+**  \brief Defines the Matrix4 class
+**
+**  \author Andrew James
+*/
+#ifndef __Matrix4
+#define __Matrix4
+
+#include "Vector3.h"
+#include "Quaternion.h"
+
+/*!
+**  \class Matrix4
+**  \brief A 4x4 transformation matrix stored in column major order (the way OpenGL wants it).
+**
+**  Lets transforms be built and composed on the CPU so they can be handed to OpenGL
+**   with a single glLoadMatrixf/glMultMatrixf call instead of leaning on the matrix stack.
+**  Products are worked out a column at a time with SSE (see Simd).
+*/
+class Matrix4
+{
+public:
+    /*!
+    **  \brief No args constructor creates an identity matrix.
+    */
+    Matrix4(void);
+
+    /*!
+    **  \brief Creates a Matrix4 from an array of 16 floats in column major order.
+    **
+    **  \param m The elements of the matrix.
+    */
+    Matrix4(const float *m);
+
+    /*!
+    **  \brief Multiplies self by the given Matrix4 then assigns the result to self.
+    **
+    **  The rhs is applied first, same as calling glMultMatrixf(rhs) on the current matrix.
+    **  \param rhs The rhs of the multiplication.
+    **  \return A reference to self.
+    */
+    Matrix4& operator*=(const Matrix4 &rhs);
+
+    /*!
+    **  \brief Multiplies self by the given Matrix4 and returns the result.
+    **
+    **  \param rhs The rhs of the multiplication.
+    **  \return The result of the multiplication.
+    */
+    const Matrix4 operator*(const Matrix4 &rhs) const;
+
+    /*!
+    **  \brief Inverts a matrix that only rotates and translates.
+    **
+    **  The rotation is undone by its transpose and the translation by rotating it back, so
+    **   there's no need for the general inverse. Gives junk for anything that scales or skews.
+    **  \return The inverse.
+    */
+    const Matrix4 RigidInverse() const;
+
+    /*!
+    **  \brief Works out the rotation of a matrix as a quaternion.
+    **
+    **  Only looks at the top left 3x3, which must be a rotation.
+    **  \return The rotation.
+    */
+    const Quaternion ToQuaternion() const;
+
+    /*!
+    **  \brief Transforms a point by the matrix (w = 1, so translation applies).
+    **
+    **  \param point The point to transform.
+    **  \return The transformed point.
+    */
+    const Vector3 TransformPoint(const Vector3 &point) const;
+
+    /*!
+    **  \brief Transforms a direction by the matrix (w = 0, so translation is ignored).
+    **
+    **  \param direction The direction to transform.
+    **  \return The transformed direction.
+    */
+    const Vector3 TransformVector(const Vector3 &direction) const;
+
+    /*!
+    **  \brief Creates a matrix that translates by the given vector.
+    **
+    **  Equivalent to glTranslatef(offset.x, offset.y, offset.z).
+    **  \param offset The translation.
+    **  \return The translation matrix.
+    */
+    static const Matrix4 Translation(const Vector3 &offset);
+
+    /*!
+    **  \brief Creates a matrix that rotates about the given axis.
+    **
+    **  Equivalent to glRotatef(degrees, axis.x, axis.y, axis.z). The axis does not need to
+    **   be unit length, but a null axis gives the identity.
+    **  \param axis The rotation axis.
+    **  \param degrees The rotation angle in degrees.
+    **  \return The rotation matrix.
+    */
+    static const Matrix4 Rotation(const Vector3 &axis, const float &degrees);
+
+    /*!
+    **  \brief Creates a matrix that rotates the same way as a quaternion.
+    **
+    **  TransformVector() on the result matches Quaternion::Rotate().
+    **  \param rotation A unit quaternion.
+    **  \return The rotation matrix.
+    */
+    static const Matrix4 FromQuaternion(const Quaternion &rotation);
+
+    /*!
+    **  \brief Works out the sine and cosine of an angle.
+    **
+    **  Boxes are only ever turned a whole degree at a time, so whole and half degrees (for
+    **   quaternions) come straight out of a table, and the right angles come out exact.
+    **   Anything else is worked out.
+    **  \param degrees The angle in degrees.
+    **  \param sine Set to the sine of the angle.
+    **  \param cosine Set to the cosine of the angle.
+    */
+    static void SinCos(const float &degrees, float &sine, float &cosine);
+
+    float m[16];    //!< The elements of the matrix in column major order.
+
+protected:
+    const static float sines[720];  //!< Sine of every half degree.
+};
+#endif
@@ -0,0 +1,68 @@
+#include "OccupancyGrid.h"
+
+#include <cmath>
+
+const std::size_t OccupancyGrid::SHARDS = 16;
+
+OccupancyGrid::Cell::Cell(void):x(0),y(0),z(0)
+{
+}
+
+OccupancyGrid::Cell::Cell(const Vector3 &position):x(static_cast<int>(floor(position.x + 0.5f))),
+                                                   y(static_cast<int>(floor(position.y + 0.5f))),
+                                                   z(static_cast<int>(floor(position.z + 0.5f)))
+{
+}
+
+bool OccupancyGrid::Cell::operator==(const Cell &rhs) const
+{
+    return this->x == rhs.x && this->y == rhs.y && this->z == rhs.z;
+}
+
+const OccupancyGrid::Cell OccupancyGrid::Cell::operator+(const Cell &rhs) const
+{
+    Cell result;
+    result.x = this->x + rhs.x;
+    result.y = this->y + rhs.y;
+    result.z = this->z + rhs.z;
+
+    return result;
+}
+
+OccupancyGrid::OccupancyGrid(void):shards(SHARDS)
+{
+}
+
+bool OccupancyGrid::Free(const Cell &cell) const
+{
+    const Table &table = this->shards[Shard(cell)];
+
+    return table.find(cell) == table.end();
+}
+
+void OccupancyGrid::Insert(const Cell &cell)
+{
+    ++this->shards[Shard(cell)][cell];
+}
+
+void OccupancyGrid::Erase(const Cell &cell)
+{
+    Table &table = this->shards[Shard(cell)];
+    Table::iterator it = table.find(cell);
+
+    if(it != table.end() && --it->second == 0)
+    {   // Only cells with something in them are kept.
+        table.erase(it);
+    }
+}
+
+std::size_t OccupancyGrid::Shard(const Cell &cell) const
+{   // The high bits, the tables spread the cells over their buckets with the low ones.
+    return (CellHash()(cell) >> 16) % SHARDS;
+}
+
+std::size_t OccupancyGrid::CellHash::operator()(const Cell &cell) const
+{   // The usual large primes from Teschner et al., "Optimized Spatial Hashing for Collision Detection of Deformable Objects".
+    //  Multiplied unsigned, where wrapping around is defined (a signed int overflows past 29 or so).
+    return (static_cast<std::size_t>(cell.x) * 73856093u) ^ (static_cast<std::size_t>(cell.y) * 19349663u) ^ (static_cast<std::size_t>(cell.z) * 83492791u);
+}
@@ -0,0 +1,133 @@
+/*!
+**  \file OccupancyGrid.h
+**  \brief Defines the OccupancyGrid class
+**
+**  \author Andrew James
+**  \sa OccupancyGrid
+*/
+#ifndef __OccupancyGrid
+#define __OccupancyGrid
+
+#include "Vector3.h"
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+/*!
+**  \class OccupancyGrid
+**  \brief Spatial hash of the unit cells taken up by boxes.
+**
+**  Boxes are unit cubes stepping one unit along an axis at a time, so each one sits in an
+**   integer cell. Keeping a hash of the taken cells means checking if a box would land
+**   inside another one is constant time, instead of walking the whole pipe.
+**  A cell can hold more than one box (twisting part of a pipe can fold it onto itself),
+**   so the grid counts the boxes in each cell.
+**  The cells are split between SHARDS separate tables by hash. Nothing is shared between
+**   them, so cells in different shards (see Shard()) can be inserted and erased from
+**   different threads at the same time.
+*/
+class OccupancyGrid
+{
+public:
+    const static std::size_t SHARDS;    //!< Number of tables the cells are split between.
+
+    /*!
+    **  \struct Cell
+    **  \brief Integer coordinates of a cell.
+    */
+    struct Cell
+    {
+        /*!
+        **  \brief No args constructor creates the cell at the origin.
+        */
+        Cell(void);
+
+        /*!
+        **  \brief Creates the cell containing the given point.
+        **
+        **  Boxes that aren't rotated by a multiple of 90 degrees don't sit exactly on the
+        **   grid, so the point is rounded to the nearest cell.
+        **  \param position The point.
+        */
+        explicit Cell(const Vector3 &position);
+
+        /*!
+        **  \brief Compares two cells.
+        **
+        **  \param rhs The cell to compare with.
+        **  \return Returns true if the cells are the same.
+        */
+        bool operator==(const Cell &rhs) const;
+
+        /*!
+        **  \brief Adds an offset to the cell.
+        **
+        **  \param rhs The offset.
+        **  \return The cell offset by rhs.
+        */
+        const Cell operator+(const Cell &rhs) const;
+
+        int x,  //!< The x coordinate.
+            y,  //!< The y coordinate.
+            z;  //!< The z coordinate.
+    };
+
+    /*!
+    **  \brief Creates an empty grid.
+    */
+    OccupancyGrid(void);
+
+    /*!
+    **  \brief Checks if a cell is empty.
+    **
+    **  \param cell The cell to check.
+    **  \return Returns true if there are no boxes in the cell.
+    */
+    bool Free(const Cell &cell) const;
+
+    /*!
+    **  \brief Records a box in a cell.
+    **
+    **  \param cell The cell the box is in.
+    */
+    void Insert(const Cell &cell);
+
+    /*!
+    **  \brief Removes a box from a cell.
+    **
+    **  Does nothing if the cell is already empty.
+    **  \param cell The cell the box was in.
+    */
+    void Erase(const Cell &cell);
+
+    /*!
+    **  \brief Returns the shard a cell is kept in.
+    **
+    **  \param cell The cell.
+    **  \return The shard, less than SHARDS.
+    */
+    std::size_t Shard(const Cell &cell) const;
+
+protected:
+    /*!
+    **  \struct CellHash
+    **  \brief Spreads cells over the hash table.
+    */
+    struct CellHash
+    {
+        /*!
+        **  \brief Hashes a cell.
+        **
+        **  \param cell The cell to hash.
+        **  \return The hash of the cell.
+        */
+        std::size_t operator()(const Cell &cell) const;
+    };
+
+    typedef boost::unordered_map<Cell, unsigned int, CellHash> Table;  //!< Number of boxes in each cell that isn't empty.
+
+    std::vector<Table> shards;  //!< The cells, split up by Shard().
+};
+#endif
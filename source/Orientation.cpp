@@ -0,0 +1,166 @@
+#include "Orientation.h"
+
+const unsigned char Orientation::INEXACT = 24;
+
+const signed char Orientation::columns[216] =
+{
+     1,  0,  0,   0,  1,  0,   0,  0,  1,
+     1,  0,  0,   0, -1,  0,   0,  0, -1,
+    -1,  0,  0,   0,  1,  0,   0,  0, -1,
+    -1,  0,  0,   0, -1,  0,   0,  0,  1,
+     1,  0,  0,   0,  0,  1,   0, -1,  0,
+     1,  0,  0,   0,  0, -1,   0,  1,  0,
+    -1,  0,  0,   0,  0,  1,   0,  1,  0,
+    -1,  0,  0,   0,  0, -1,   0, -1,  0,
+     0,  1,  0,   1,  0,  0,   0,  0, -1,
+     0,  1,  0,  -1,  0,  0,   0,  0,  1,
+     0, -1,  0,   1,  0,  0,   0,  0,  1,
+     0, -1,  0,  -1,  0,  0,   0,  0, -1,
+     0,  1,  0,   0,  0,  1,   1,  0,  0,
+     0,  1,  0,   0,  0, -1,  -1,  0,  0,
+     0, -1,  0,   0,  0,  1,  -1,  0,  0,
+     0, -1,  0,   0,  0, -1,   1,  0,  0,
+     0,  0,  1,   1,  0,  0,   0,  1,  0,
+     0,  0,  1,  -1,  0,  0,   0, -1,  0,
+     0,  0, -1,   1,  0,  0,   0, -1,  0,
+     0,  0, -1,  -1,  0,  0,   0,  1,  0,
+     0,  0,  1,   0,  1,  0,  -1,  0,  0,
+     0,  0,  1,   0, -1,  0,   1,  0,  0,
+     0,  0, -1,   0,  1,  0,   1,  0,  0,
+     0,  0, -1,   0, -1,  0,  -1,  0,  0,
+};
+
+const float Orientation::quaternions[96] =
+{
+            1.0f,         0.0f,         0.0f,         0.0f,
+            0.0f,         1.0f,         0.0f,         0.0f,
+            0.0f,         0.0f,         1.0f,         0.0f,
+            0.0f,         0.0f,         0.0f,         1.0f,
+     0.70710677f,  0.70710677f,         0.0f,         0.0f,
+     0.70710677f, -0.70710677f,         0.0f,         0.0f,
+            0.0f,         0.0f,  0.70710677f,  0.70710677f,
+            0.0f,         0.0f, -0.70710677f,  0.70710677f,
+            0.0f,  0.70710677f,  0.70710677f,         0.0f,
+     0.70710677f,         0.0f,         0.0f,  0.70710677f,
+     0.70710677f,         0.0f,         0.0f, -0.70710677f,
+            0.0f, -0.70710677f,  0.70710677f,         0.0f,
+            0.5f,         0.5f,         0.5f,         0.5f,
+            0.5f,        -0.5f,        -0.5f,         0.5f,
+           -0.5f,        -0.5f,         0.5f,         0.5f,
+           -0.5f,         0.5f,        -0.5f,         0.5f,
+           -0.5f,         0.5f,         0.5f,         0.5f,
+            0.5f,         0.5f,        -0.5f,         0.5f,
+           -0.5f,        -0.5f,        -0.5f,         0.5f,
+            0.5f,        -0.5f,         0.5f,         0.5f,
+     0.70710677f,         0.0f, -0.70710677f,         0.0f,
+            0.0f,  0.70710677f,         0.0f,  0.70710677f,
+     0.70710677f,         0.0f,  0.70710677f,         0.0f,
+            0.0f, -0.70710677f,         0.0f,  0.70710677f,
+};
+
+const unsigned char Orientation::products[576] =
+{
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23,
+     1,  0,  3,  2,  5,  4,  7,  6, 10, 11,  8,  9, 15, 14, 13, 12, 18, 19, 16, 17, 23, 22, 21, 20,
+     2,  3,  0,  1,  7,  6,  5,  4,  9,  8, 11, 10, 13, 12, 15, 14, 19, 18, 17, 16, 22, 23, 20, 21,
+     3,  2,  1,  0,  6,  7,  4,  5, 11, 10,  9,  8, 14, 15, 12, 13, 17, 16, 19, 18, 21, 20, 23, 22,
+     4,  5,  6,  7,  1,  0,  3,  2, 16, 17, 18, 19, 21, 20, 23, 22, 10, 11,  8,  9, 14, 15, 12, 13,
+     5,  4,  7,  6,  0,  1,  2,  3, 18, 19, 16, 17, 22, 23, 20, 21,  8,  9, 10, 11, 13, 12, 15, 14,
+     6,  7,  4,  5,  2,  3,  0,  1, 17, 16, 19, 18, 20, 21, 22, 23,  9,  8, 11, 10, 12, 13, 14, 15,
+     7,  6,  5,  4,  3,  2,  1,  0, 19, 18, 17, 16, 23, 22, 21, 20, 11, 10,  9,  8, 15, 14, 13, 12,
+     8,  9, 10, 11, 13, 12, 15, 14,  0,  1,  2,  3,  5,  4,  7,  6, 22, 23, 20, 21, 18, 19, 16, 17,
+     9,  8, 11, 10, 12, 13, 14, 15,  2,  3,  0,  1,  6,  7,  4,  5, 20, 21, 22, 23, 17, 16, 19, 18,
+    10, 11,  8,  9, 14, 15, 12, 13,  1,  0,  3,  2,  4,  5,  6,  7, 21, 20, 23, 22, 16, 17, 18, 19,
+    11, 10,  9,  8, 15, 14, 13, 12,  3,  2,  1,  0,  7,  6,  5,  4, 23, 22, 21, 20, 19, 18, 17, 16,
+    12, 13, 14, 15,  8,  9, 10, 11, 20, 21, 22, 23, 16, 17, 18, 19,  0,  1,  2,  3,  4,  5,  6,  7,
+    13, 12, 15, 14,  9,  8, 11, 10, 22, 23, 20, 21, 19, 18, 17, 16,  2,  3,  0,  1,  7,  6,  5,  4,
+    14, 15, 12, 13, 11, 10,  9,  8, 21, 20, 23, 22, 17, 16, 19, 18,  3,  2,  1,  0,  6,  7,  4,  5,
+    15, 14, 13, 12, 10, 11,  8,  9, 23, 22, 21, 20, 18, 19, 16, 17,  1,  0,  3,  2,  5,  4,  7,  6,
+    16, 17, 18, 19, 20, 21, 22, 23,  4,  5,  6,  7,  0,  1,  2,  3, 12, 13, 14, 15,  8,  9, 10, 11,
+    17, 16, 19, 18, 21, 20, 23, 22,  6,  7,  4,  5,  3,  2,  1,  0, 14, 15, 12, 13, 11, 10,  9,  8,
+    18, 19, 16, 17, 23, 22, 21, 20,  5,  4,  7,  6,  1,  0,  3,  2, 15, 14, 13, 12, 10, 11,  8,  9,
+    19, 18, 17, 16, 22, 23, 20, 21,  7,  6,  5,  4,  2,  3,  0,  1, 13, 12, 15, 14,  9,  8, 11, 10,
+    20, 21, 22, 23, 17, 16, 19, 18, 12, 13, 14, 15,  9,  8, 11, 10,  6,  7,  4,  5,  2,  3,  0,  1,
+    21, 20, 23, 22, 16, 17, 18, 19, 14, 15, 12, 13, 10, 11,  8,  9,  4,  5,  6,  7,  1,  0,  3,  2,
+    22, 23, 20, 21, 18, 19, 16, 17, 13, 12, 15, 14,  8,  9, 10, 11,  5,  4,  7,  6,  0,  1,  2,  3,
+    23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  0,
+};
+
+const unsigned char Orientation::turns[24] =
+{
+     0,  4,  1,  5,
+     0, 22,  2, 20,
+     0,  9,  3, 10,
+     0,  5,  1,  4,
+     0, 20,  2, 22,
+     0, 10,  3,  9,
+};
+
+Orientation::Orientation(void):index(0)
+{
+}
+
+Orientation::Orientation(const int &face, const int &quarters):index(turns[face * 4 + quarters])
+{
+}
+
+const Orientation Orientation::Inexact()
+{
+    Orientation result;
+    result.index = INEXACT;
+
+    return result;
+}
+
+bool Orientation::Exact() const
+{
+    return this->index != INEXACT;
+}
+
+const Orientation Orientation::operator*(const Orientation &rhs) const
+{
+    if(!Exact() || !rhs.Exact())
+    {
+        return Inexact();
+    }
+
+    Orientation result;
+    result.index = products[this->index * 24 + rhs.index];
+
+    return result;
+}
+
+const OccupancyGrid::Cell Orientation::Rotate(const OccupancyGrid::Cell &offset) const
+{
+    const signed char *column = &columns[this->index * 9];
+    OccupancyGrid::Cell result;
+
+    result.x = column[0] * offset.x + column[3] * offset.y + column[6] * offset.z;
+    result.y = column[1] * offset.x + column[4] * offset.y + column[7] * offset.z;
+    result.z = column[2] * offset.x + column[5] * offset.y + column[8] * offset.z;
+
+    return result;
+}
+
+const Matrix4 Orientation::Matrix(const OccupancyGrid::Cell &position) const
+{
+    const signed char *column = &columns[this->index * 9];
+    float m[16] = {0.0f};
+
+    for(int i = 0; i < 9; ++i)
+    {   // Column major, so each column of three goes in the top of a column of four.
+        m[(i / 3) * 4 + i % 3] = static_cast<float>(column[i]);
+    }
+
+    m[12] = static_cast<float>(position.x);
+    m[13] = static_cast<float>(position.y);
+    m[14] = static_cast<float>(position.z);
+    m[15] = 1.0f;
+
+    return Matrix4(m);
+}
+
+const DualQuaternion Orientation::Placement(const OccupancyGrid::Cell &position) const
+{
+    return DualQuaternion(&quaternions[this->index * 4], Vector3(static_cast<float>(position.x), static_cast<float>(position.y), static_cast<float>(position.z)));
+}
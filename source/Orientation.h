@@ -0,0 +1,103 @@
+/*!
+**  \file Orientation.h
+**  \brief Defines the Orientation class
+**
+**  \author Andrew James
+**  \sa Orientation
+*/
+#ifndef __Orientation
+#define __Orientation
+
+#include "DualQuaternion.h"
+#include "Matrix4.h"
+#include "OccupancyGrid.h"
+
+/*!
+**  \class Orientation
+**  \brief One of the 24 ways of turning a cube onto itself, or a turn that isn't one.
+**
+**  A box on one of the six unit axes, turned by a multiple of 90 degrees, lines its faces
+**   up with the previous box's. A chain of boxes like that only ever faces one of 24 ways,
+**   so the chain can be followed with a table lookup per box and whole number cells
+**   instead of sines, cosines and rounding. Nothing drifts however long the pipe gets, and
+**   the cells the grid sees are exact.
+**  As soon as a box turns by any other angle the chain is off the grid, and everything
+**   after it has to be worked out the long way with matrices (see Exact()).
+*/
+class Orientation
+{
+public:
+    /*!
+    **  \brief No args constructor creates the orientation that isn't turned at all.
+    */
+    Orientation(void);
+
+    /*!
+    **  \brief Creates a turn about one of the six unit axes.
+    **
+    **  Turns the same way as Matrix4::Rotation().
+    **  \param face The axis to turn about, as a face index (see Box::Face()).
+    **  \param quarters How many quarter turns to make (0 to 3).
+    */
+    Orientation(const int &face, const int &quarters);
+
+    /*!
+    **  \brief Returns an orientation that is off the grid.
+    **
+    **  \return An orientation for which Exact() is false.
+    */
+    static const Orientation Inexact();
+
+    /*!
+    **  \brief Checks if the orientation is one of the 24.
+    **
+    **  \return Returns true if the orientation is exact.
+    */
+    bool Exact() const;
+
+    /*!
+    **  \brief Applies rhs first, then self.
+    **
+    **  Off the grid if either side is.
+    **  \param rhs The rhs of the multiplication.
+    **  \return The combined orientation.
+    */
+    const Orientation operator*(const Orientation &rhs) const;
+
+    /*!
+    **  \brief Turns a cell offset (only for exact orientations).
+    **
+    **  \param offset The offset to turn.
+    **  \return The turned offset.
+    */
+    const OccupancyGrid::Cell Rotate(const OccupancyGrid::Cell &offset) const;
+
+    /*!
+    **  \brief Builds the placement of a box facing this way at the given cell (only for exact orientations).
+    **
+    **  Comes straight from a table, so nothing carries over from the boxes before it.
+    **  \param position Cell the box sits in.
+    **  \return The placement.
+    */
+    const DualQuaternion Placement(const OccupancyGrid::Cell &position) const;
+
+    /*!
+    **  \brief Builds the matrix of a box facing this way at the given cell (only for exact orientations).
+    **
+    **  Every element is a whole number, so unlike Placement().Matrix() (which goes through
+    **   the square roots in the quaternions) it comes out exact.
+    **  \param position Cell the box sits in.
+    **  \return The transform from the head to the box.
+    */
+    const Matrix4 Matrix(const OccupancyGrid::Cell &position) const;
+
+protected:
+    unsigned char index;    //!< Which of the 24 orientations (24 if it's off the grid).
+
+    const static unsigned char INEXACT;         //!< Index of an orientation that's off the grid.
+    const static signed char columns[216];      //!< The three columns of the matrix of each orientation.
+    const static float quaternions[96];         //!< The rotation of each orientation as a quaternion (w, x, y, z).
+    const static unsigned char products[576];   //!< Index of the product of every pair of orientations, lhs major.
+    const static unsigned char turns[24];       //!< Index of each number of quarter turns about each face's axis.
+};
+#endif
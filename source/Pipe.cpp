@@ -0,0 +1,632 @@
+#include "Pipe.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+
+const Box::Handle Pipe::HEAD = 0;
+const std::size_t Pipe::SCANBLOCK = 4096;
+const std::size_t Pipe::SETTLEBUDGET = 4096;
+
+JobPool *Pipe::jobs = 0;
+
+Pipe::Pipe(const Vector3 &position):head(position),boxes(1, Box()),last(HEAD),freeList(Box::NONE),retired(Box::NONE),retiredLast(Box::NONE),dropped(Box::NONE),grid(),unplaced(Box::NONE),mesh(),stale(true),restart(0),reach(PipeMesh::NONE),prepared(false),unwalked(Box::NONE),walked(0),active(PipeMesh::NONE),order(),positions()
+{   // Slot 0 is never used, it just keeps handles lined up with the pool.
+    this->grid.Insert(this->head.cell);
+}
+
+MasterBox& Pipe::Head()
+{   // Whoever has the head can move it.
+    Touch(HEAD);
+
+    return this->head;
+}
+
+const MasterBox& Pipe::Head() const
+{
+    return this->head;
+}
+
+Box& Pipe::operator[](const Box::Handle &handle)
+{
+    Touch(handle);
+
+    if(handle == HEAD)
+    {
+        return this->head;
+    }
+
+    return this->boxes[handle];
+}
+
+const Box& Pipe::operator[](const Box::Handle &handle) const
+{
+    if(handle == HEAD)
+    {
+        return this->head;
+    }
+
+    return this->boxes[handle];
+}
+
+Box::Handle Pipe::Last() const
+{
+    return this->last;
+}
+
+Box::Handle Pipe::Append(const Box &box)
+{   // The box is rotated about its own centre, so it ends up one step along its axis from the last box.
+    Settle();
+
+    Box placed(box);
+    placed.PlaceAfter((*this)[this->last]);
+
+    if(!Vacant(placed.cell))
+    {
+        return Box::NONE;
+    }
+
+    return InsertAfter(this->last, box);
+}
+
+Box::Handle Pipe::InsertAfter(const Box::Handle &handle, const Box &box)
+{
+    Settle();
+
+    Touch(handle);
+
+    Box &prev = (*this)[handle];
+
+    if(!prev.Accepts(box) || ((prev.next != Box::NONE) && !box.Accepts(this->boxes[prev.next])))
+    {   // The new box would be drawn inside one of its neighbours.
+        return Box::NONE;
+    }
+
+    Box::Handle inserted = Allocate(box);
+
+    // Allocate() may have moved the pool, so look the neighbours up again.
+    Box &before = (*this)[handle];
+    Box &current = this->boxes[inserted];
+
+    current.prev = handle;
+    current.next = before.next;
+    current.isActive = false;
+    current.dirty = true;
+
+    if(current.next != Box::NONE)
+    {   // The box after us hangs off a different transform now.
+        this->boxes[current.next].prev = inserted;
+        this->boxes[current.next].dirty = true;
+    }
+    else
+    {
+        this->last = inserted;
+    }
+
+    before.next = inserted;
+
+    current.PlaceAfter(before);
+    this->grid.Insert(current.cell);
+
+    if(current.next != Box::NONE)
+    {
+        Place(current.next);
+    }
+
+    return inserted;
+}
+
+bool Pipe::Remove(const Box::Handle &handle)
+{
+    Settle();
+
+    Touch(handle);
+
+    Box &current = this->boxes[handle];
+    Box &prev = (*this)[current.prev];
+
+    if((current.next != Box::NONE) && !prev.Accepts(this->boxes[current.next]))
+    {   // Joining the neighbours would put one inside the other.
+        return false;
+    }
+
+    prev.next = current.next;
+    this->grid.Erase(current.cell);
+
+    if(current.next != Box::NONE)
+    {
+        this->boxes[current.next].prev = current.prev;
+        this->boxes[current.next].dirty = true;
+
+        Place(current.next);
+    }
+    else
+    {   // We're deleting the tail.
+        this->last = current.prev;
+    }
+
+    current.next = this->freeList;
+    current.prev = Box::NONE;
+    this->freeList = handle;
+
+    return true;
+}
+
+void Pipe::Truncate(const Box::Handle &handle)
+{
+    Settle();
+
+    Touch(handle);
+
+    Box &current = this->boxes[handle];
+
+    (*this)[current.prev].next = Box::NONE;
+
+    // The tail is already a list, hook it onto the end of the retired boxes and we're done.
+    //  Release() takes their cells out of the grid later, in the same order.
+    if(this->retired == Box::NONE)
+    {
+        this->retired = handle;
+    }
+    else
+    {
+        this->boxes[this->retiredLast].next = handle;
+    }
+
+    if(this->dropped == Box::NONE)
+    {
+        this->dropped = handle;
+    }
+
+    this->retiredLast = this->last;
+
+    this->last = current.prev;
+    current.prev = Box::NONE;
+}
+
+bool Pipe::PromoteNext()
+{
+    Settle();
+
+    Touch(HEAD);
+
+    Box::Handle next = this->head.next;
+
+    if(next == Box::NONE)
+    {
+        return false;
+    }
+
+    this->grid.Erase(this->head.cell);
+    this->grid.Erase(this->boxes[next].cell);
+
+    this->head = MasterBox(this->boxes[next]);
+    this->grid.Insert(this->head.cell);
+
+    if(this->head.next != Box::NONE)
+    {   // Everything is relative to the head, and the head just changed.
+        this->boxes[this->head.next].prev = HEAD;
+
+        Place(this->head.next);
+    }
+    else
+    {   // The promoted box was the tail.
+        this->last = HEAD;
+    }
+
+    this->boxes[next].next = this->freeList;
+    this->boxes[next].prev = Box::NONE;
+    this->freeList = next;
+
+    return true;
+}
+
+void Pipe::Rotate(const Box::Handle &handle, const float &angle)
+{
+    if(handle == HEAD)
+    {   // The head can't be rotated this way (see Box::Rotate), so nothing moves.
+        return;
+    }
+
+    Settle();
+
+    Touch(handle);
+    this->boxes[handle].Rotate(angle);
+
+    Place(handle);
+}
+
+void Pipe::Reserve(const std::size_t &boxes)
+{   // Slot 0 belongs to the head.
+    this->boxes.reserve(boxes + 1);
+}
+
+Box::Handle Pipe::Restore(const Box &box)
+{
+    Touch(this->last);
+
+    Box::Handle restored = Allocate(box);
+    Box &current = this->boxes[restored];
+
+    current.prev = this->last;
+    current.next = Box::NONE;
+    current.isActive = false;
+    current.dirty = true;
+
+    (*this)[this->last].next = restored;
+    this->last = restored;
+
+    if(this->unplaced == Box::NONE)
+    {   // Everything from here on gets placed by Settle().
+        this->unplaced = restored;
+    }
+
+    return restored;
+}
+
+void Pipe::UseJobs(JobPool *jobs)
+{
+    Pipe::jobs = jobs;
+}
+
+void Pipe::Prepare(JobPool &jobs) const
+{   // A long restored pipe is placed a slice a frame, so loading it doesn't hold everything up,
+    //  and a long tail cut off the pipe is taken out of the grid the same way.
+    Release(SETTLEBUDGET);
+    Settle(SETTLEBUDGET);
+
+    this->prepared = true;
+
+    if(!this->stale && this->unwalked == this->unplaced)
+    {   // Nothing changed and nothing new was placed.
+        return;
+    }
+
+    std::size_t moved = Walk();
+
+    // Worked out once here, the head caches its matrix and the jobs mustn't all fill the cache in at once.
+    const Matrix4 origin = this->head.LocalMatrix();
+
+    for(std::size_t begin = moved; begin < this->mesh.Size(); begin += PipeMesh::SEGMENT)
+    {   // A segment's worth of boxes is plenty to make a job worth queueing.
+        jobs.Add(boost::bind(&Pipe::Transform, this, begin, std::min(begin + PipeMesh::SEGMENT, this->mesh.Size()), origin));
+    }
+}
+
+bool Pipe::Current() const
+{
+    return !this->stale && this->unplaced == Box::NONE && this->unwalked == Box::NONE && this->dropped == Box::NONE;
+}
+
+void Pipe::Draw(const Frustum &frustum, const Detail &detail) const
+{
+    if(!this->prepared)
+    {
+        Release(SETTLEBUDGET);
+        Settle(SETTLEBUDGET);
+    }
+
+    this->prepared = false;
+
+    if(this->stale || this->unwalked != this->unplaced)
+    {   // Not prepared, do it all here.
+        std::size_t moved = Walk();
+
+        Transform(moved, this->mesh.Size(), this->head.LocalMatrix());
+    }
+
+    this->mesh.Draw(this->active, frustum, detail);
+}
+
+Box::Handle Pipe::Allocate(const Box &box)
+{
+    if(this->freeList != Box::NONE)
+    {   // Reuse an old slot if there is one.
+        Box::Handle handle = this->freeList;
+        this->freeList = this->boxes[handle].next;
+        this->boxes[handle] = box;
+        Forget(handle);
+
+        return handle;
+    }
+
+    if(this->retired != Box::NONE && this->retired != this->dropped)
+    {   // Then a slot cut off by Truncate(), as long as its cell is out of the grid.
+        Box::Handle handle = this->retired;
+        this->retired = this->boxes[handle].next;
+        this->boxes[handle] = box;
+        Forget(handle);
+
+        return handle;
+    }
+
+    this->boxes.push_back(box);
+
+    return static_cast<Box::Handle>(this->boxes.size() - 1);
+}
+
+void Pipe::Place(const Box::Handle &handle)
+{   // Anything after the box hangs off it, so it all moves with it.
+    std::vector<Box::Handle> chain;
+
+    for(Box::Handle current = handle; current != Box::NONE; current = this->boxes[current].next)
+    {
+        chain.push_back(current);
+    }
+
+    const Box base = (*this)[this->boxes[handle].prev];
+    std::size_t blocks = 1;
+
+    if(jobs && chain.size() >= 2 * SCANBLOCK)
+    {   // A few blocks per thread, so a thread that gets held up doesn't hold everything up.
+        blocks = std::min(chain.size() / SCANBLOCK, jobs->Threads() * 4);
+    }
+
+    // The old and new cells of each block, sorted by shard so each shard can be updated on its own.
+    std::vector<ShardedCells> removed(blocks, ShardedCells(OccupancyGrid::SHARDS));
+    std::vector<ShardedCells> added(blocks, ShardedCells(OccupancyGrid::SHARDS));
+
+    if(blocks == 1)
+    {
+        Scan(chain, 0, chain.size(), base, removed[0]);
+        Collect(chain, 0, chain.size(), added[0]);
+
+        for(std::size_t shard = 0; shard < OccupancyGrid::SHARDS; ++shard)
+        {
+            Refile(removed, added, shard);
+        }
+
+        return;
+    }
+
+    std::size_t size = (chain.size() + blocks - 1) / blocks;
+    std::vector<Box> offsets;
+
+    // The first block can go straight into place, the rest start off relative to the box before them.
+    for(std::size_t begin = 0, block = 0; begin < chain.size(); begin += size, ++block)
+    {
+        jobs->Add(boost::bind(&Pipe::Scan, this, boost::cref(chain), begin, std::min(begin + size, chain.size()), (begin == 0) ? base : Box(), boost::ref(removed[block])));
+    }
+
+    jobs->Wait();
+
+    // Chain the blocks together, only one product per block.
+    for(std::size_t begin = size; begin < chain.size(); begin += size)
+    {
+        offsets.push_back(this->boxes[chain[begin - 1]]);
+
+        if(offsets.size() > 1)
+        {
+            offsets.back().PlaceWithin(offsets[offsets.size() - 2]);
+        }
+    }
+
+    jobs->Add(boost::bind(&Pipe::Collect, this, boost::cref(chain), 0, size, boost::ref(added[0])));
+
+    for(std::size_t begin = size, block = 1; begin < chain.size(); begin += size, ++block)
+    {
+        jobs->Add(boost::bind(&Pipe::Shift, this, boost::cref(chain), begin, std::min(begin + size, chain.size()), offsets[block - 1], boost::ref(added[block])));
+    }
+
+    jobs->Wait();
+
+    for(std::size_t shard = 0; shard < OccupancyGrid::SHARDS; ++shard)
+    {   // The shards share nothing, so they're all updated at once.
+        jobs->Add(boost::bind(&Pipe::Refile, this, boost::cref(removed), boost::cref(added), shard));
+    }
+
+    jobs->Wait();
+}
+
+void Pipe::Scan(const std::vector<Box::Handle> &chain, const std::size_t &begin, const std::size_t &end, const Box &base, ShardedCells &removed)
+{   // The old cells have to be noted before they're overwritten.
+    Collect(chain, begin, end, removed);
+
+    for(std::size_t i = begin; i < end; ++i)
+    {
+        this->boxes[chain[i]].PlaceAfter((i == begin) ? base : this->boxes[chain[i - 1]]);
+    }
+}
+
+void Pipe::Shift(const std::vector<Box::Handle> &chain, const std::size_t &begin, const std::size_t &end, const Box &offset, ShardedCells &added)
+{
+    for(std::size_t i = begin; i < end; ++i)
+    {
+        this->boxes[chain[i]].PlaceWithin(offset);
+    }
+
+    Collect(chain, begin, end, added);
+}
+
+void Pipe::Collect(const std::vector<Box::Handle> &chain, const std::size_t &begin, const std::size_t &end, ShardedCells &cells) const
+{
+    for(std::size_t i = begin; i < end; ++i)
+    {
+        const OccupancyGrid::Cell &cell = this->boxes[chain[i]].cell;
+
+        cells[this->grid.Shard(cell)].push_back(cell);
+    }
+}
+
+void Pipe::Refile(const std::vector<ShardedCells> &removed, const std::vector<ShardedCells> &added, const std::size_t &shard)
+{   // Every block's old cells come out before any new ones go in, same as doing the whole run at once.
+    for(std::vector<ShardedCells>::const_iterator block = removed.begin(); block != removed.end(); ++block)
+    {
+        for(std::vector<OccupancyGrid::Cell>::const_iterator it = (*block)[shard].begin(); it != (*block)[shard].end(); ++it)
+        {
+            this->grid.Erase(*it);
+        }
+    }
+
+    for(std::vector<ShardedCells>::const_iterator block = added.begin(); block != added.end(); ++block)
+    {
+        for(std::vector<OccupancyGrid::Cell>::const_iterator it = (*block)[shard].begin(); it != (*block)[shard].end(); ++it)
+        {
+            this->grid.Insert(*it);
+        }
+    }
+}
+
+std::size_t Pipe::Walk() const
+{   // Each box already knows where it is relative to the head, and only boxes
+    //  that moved are baked into the mesh again.
+    std::size_t moved = PipeMesh::NONE;
+    std::size_t index = std::min(this->restart, this->walked);
+    const std::size_t previous = this->active;
+    Box::Handle handle = HEAD;
+    const Box *prev = 0;
+
+    this->order.resize(this->boxes.size());
+    this->positions.resize(this->boxes.size(), PipeMesh::NONE);
+
+    if(index > 0)
+    {   // Everything before the first box that was touched is as it was.
+        prev = &(*this)[this->order[index - 1]];
+        handle = prev->next;
+    }
+
+    if(this->active != PipeMesh::NONE && this->active >= index)
+    {
+        this->active = PipeMesh::NONE;
+    }
+
+    for(; handle != Box::NONE && handle != this->unplaced; handle = prev->next, ++index)
+    {
+        const Box *box = &(*this)[handle];
+
+        if(moved == PipeMesh::NONE && index > this->reach && index < this->walked)
+        {   // Past the boxes that were touched and nothing moved, the rest is as it was.
+            if(previous != PipeMesh::NONE && previous >= index)
+            {   // The active box is further on, and hasn't changed either.
+                this->active = previous;
+            }
+
+            this->restart = PipeMesh::NONE;
+            this->reach = 0;
+            this->stale = false;
+
+            return this->mesh.Size();
+        }
+
+        if(index >= this->mesh.Size())
+        {   // Boxes added since the last draw are dirty, so they'll be baked.
+            this->mesh.Resize(index + 1);
+        }
+
+        if(moved == PipeMesh::NONE && box->dirty)
+        {   // Once one box has moved, everything after it has moved too.
+            moved = index;
+        }
+
+        if(moved != PipeMesh::NONE)
+        {
+            box->dirty = false;
+        }
+
+        this->order[index] = handle;
+        this->positions[handle] = index;
+
+        if(box->isActive)
+        {   // Drawn as lines instead of faces.
+            this->active = index;
+            this->mesh.SetFaces(index, 0, box->Continues());
+        }
+        else
+        {
+            this->mesh.SetFaces(index, box->VisibleFaces(prev, (box->next != Box::NONE) ? &this->boxes[box->next] : 0), box->Continues());
+        }
+
+        prev = box;
+    }
+
+    // Drops any boxes cut off the end since the last draw.
+    this->mesh.Resize(index);
+
+    this->unwalked = handle;
+    this->walked = index;
+
+    moved = std::min(moved, index);
+    this->mesh.Moved(moved, index);
+    this->restart = PipeMesh::NONE;
+    this->reach = 0;
+    this->stale = false;
+
+    return moved;
+}
+
+void Pipe::Touch(const Box::Handle &handle)
+{   // The box before it as well, its faces depend on this one.
+    const Box::Handle prev = (handle == HEAD) ? Box::NONE : this->boxes[handle].prev;
+    const std::size_t position = Position(handle);
+
+    this->stale = true;
+    this->restart = std::min(this->restart, (prev == Box::NONE) ? 0 : Position(prev));
+
+    // And the box after it. A box that hasn't been walked yet is new, and dirty, so the walk goes to the end anyway.
+    this->reach = (position == PipeMesh::NONE) ? PipeMesh::NONE : std::max(this->reach, position + 1);
+}
+
+void Pipe::Forget(const Box::Handle &handle)
+{   // The slot's last box was somewhere else entirely.
+    if(handle < this->positions.size())
+    {
+        this->positions[handle] = PipeMesh::NONE;
+    }
+}
+
+std::size_t Pipe::Position(const Box::Handle &handle) const
+{
+    if(handle == HEAD)
+    {
+        return 0;
+    }
+
+    return (handle < this->positions.size()) ? this->positions[handle] : PipeMesh::NONE;
+}
+
+void Pipe::Transform(const std::size_t &begin, const std::size_t &end, const Matrix4 &origin) const
+{
+    for(std::size_t index = begin; index < end; ++index)
+    {
+        this->mesh.Transform(index, origin * (*this)[this->order[index]].PlacementMatrix());
+    }
+}
+
+void Pipe::Release(const std::size_t &budget) const
+{
+    for(std::size_t released = 0; this->dropped != Box::NONE && released < budget; ++released)
+    {
+        this->grid.Erase(this->boxes[this->dropped].cell);
+        this->dropped = this->boxes[this->dropped].next;
+    }
+}
+
+bool Pipe::Vacant(const OccupancyGrid::Cell &cell) const
+{
+    while(!this->grid.Free(cell) && this->dropped != Box::NONE)
+    {   // Might only be a dropped box in the way.
+        Release(SETTLEBUDGET);
+    }
+
+    return this->grid.Free(cell);
+}
+
+void Pipe::Settle() const
+{
+    Settle(std::numeric_limits<std::size_t>::max());
+}
+
+void Pipe::Settle(const std::size_t &budget) const
+{   // Same as Place(), but none of these boxes are in the grid yet.
+    for(std::size_t placed = 0; this->unplaced != Box::NONE && placed < budget; ++placed)
+    {
+        const Box &box = this->boxes[this->unplaced];
+
+        box.PlaceAfter((*this)[box.prev]);
+        this->grid.Insert(box.cell);
+
+        this->unplaced = box.next;
+    }
+}
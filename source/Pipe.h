@@ -0,0 +1,377 @@
+/*!
+**  \file Pipe.h
+**  \brief Defines the Pipe class
+**
+**  \author Andrew James
+**  \sa Pipe
+*/
+#ifndef __Pipe
+#define __Pipe
+
+#include "Box.h"
+#include "PipeMesh.h"
+#include "OccupancyGrid.h"
+#include "JobPool.h"
+
+#include <vector>
+
+/*!
+**  \class Pipe
+**  \brief A MasterBox and the list of boxes hanging off it.
+**
+**  All the boxes in a pipe live in one contiguous pool and link to each other by handle,
+**   so walking a pipe doesn't chase separate heap allocations or touch reference counts.
+**  Handles stay valid until the box they refer to is removed. Removed slots go on a free
+**   list and get reused by later inserts, so inserting, removing and cutting off the tail
+**   of a pipe are all constant time.
+**  The pipe also keeps an OccupancyGrid of the cells its boxes take up, so appending a box
+**   can refuse to put it inside another box in constant time. Cells are relative to the
+**   head, so moving or turning the head (MasterBox::Dolly() and friends) never touches
+**   the grid. Edits in the middle of the pipe move every box after them, so those boxes
+**   get new cells too.
+**  Boxes turned by right angles are placed with whole numbers (see Orientation), so the
+**   cells of a long pipe don't wander off as rounding errors pile up.
+*/
+class Pipe
+{
+public:
+    const static Box::Handle HEAD;  //!< Handle of the MasterBox at the head of every pipe.
+
+    /*!
+    **  \brief Creates a pipe with only a MasterBox at the specified position.
+    **
+    **  \param position Vector3 describing the position of the head.
+    */
+    Pipe(const Vector3 &position);
+
+    /*!
+    **  \brief Getter for the head of the pipe.
+    **
+    **  \return A reference to the MasterBox at the head of the pipe.
+    */
+    MasterBox& Head();
+
+    /*!
+    **  \brief Getter for the head of the pipe. (const version)
+    **
+    **  \return A reference to the MasterBox at the head of the pipe.
+    */
+    const MasterBox& Head() const;
+
+    /*!
+    **  \brief Returns the box with the given handle.
+    **
+    **  \param handle Handle of a box in this pipe (Pipe::HEAD for the head).
+    **  \return A reference to the box.
+    */
+    Box& operator[](const Box::Handle &handle);
+
+    /*!
+    **  \brief Returns the box with the given handle. (const version)
+    **
+    **  \param handle Handle of a box in this pipe (Pipe::HEAD for the head).
+    **  \return A reference to the box.
+    */
+    const Box& operator[](const Box::Handle &handle) const;
+
+    /*!
+    **  \brief Returns the handle of the last box in the pipe.
+    **
+    **  \return The handle of the tail (Pipe::HEAD if the pipe has no other boxes).
+    */
+    Box::Handle Last() const;
+
+    /*!
+    **  \brief Adds a box to the end of the pipe.
+    **
+    **  \param box The box to add.
+    **  \return The handle of the new box, or Box::NONE if the box would be drawn inside
+    **           another box in the pipe. If the return value is Box::NONE, the pipe has not been modified.
+    */
+    Box::Handle Append(const Box &box);
+
+    /*!
+    **  \brief Inserts a box into the pipe after the given box.
+    **
+    **  Only the neighbours are checked, the boxes after the new one move along to make room
+    **   for it and may well end up inside something.
+    **  \param handle Handle of the box to insert after.
+    **  \param box The box to insert.
+    **  \return The handle of the new box, or Box::NONE if the box clashes with either of
+    **           its neighbours. If the return value is Box::NONE, the pipe has not been modified.
+    */
+    Box::Handle InsertAfter(const Box::Handle &handle, const Box &box);
+
+    /*!
+    **  \brief Removes a box from the pipe, joining its neighbours together.
+    **
+    **  The head can't be removed this way, see PromoteNext().
+    **  \param handle Handle of the box to remove.
+    **  \return Returns true if the box was removed, false if the boxes either side would
+    **           clash. If the return value is false, the pipe has not been modified.
+    */
+    bool Remove(const Box::Handle &handle);
+
+    /*!
+    **  \brief Drops the given box and every box after it.
+    **
+    **  The dropped boxes are already linked together, so they're set aside in one go. Their
+    **   cells come out of the grid a slice a frame (see Release()), and their slots are only
+    **   reused once they have.
+    **  \param handle Handle of the first box to drop (must not be the head).
+    */
+    void Truncate(const Box::Handle &handle);
+
+    /*!
+    **  \brief Removes the head of the pipe, making the next box the new head.
+    **
+    **  The new head starts at the origin, the same as a new pipe.
+    **  \return Returns true if there was a box to promote, false if the head is the
+    **           only box in the pipe (in which case the whole pipe should be dropped).
+    */
+    bool PromoteNext();
+
+    /*!
+    **  \brief Rotates a box about its rotation axis.
+    **
+    **  Every box after it swings around with it, so they all get new cells.
+    **  \param handle Handle of the box to rotate.
+    **  \param angle Rotation angle in degrees.
+    */
+    void Rotate(const Box::Handle &handle, const float &angle);
+
+    /*!
+    **  \brief Makes room in the pool for the given number of boxes.
+    **
+    **  \param boxes The number of boxes (not counting the head).
+    */
+    void Reserve(const std::size_t &boxes);
+
+    /*!
+    **  \brief Adds a box to the end of the pipe without checking it.
+    **
+    **  For rebuilding a pipe that was checked when it was first built (see SceneFile).
+    **   Working out where the restored boxes are and filling in their cells is put off,
+    **   so restoring a box costs no more than copying it into the pool. Each frame places
+    **   another SETTLEBUDGET of them and the pipe grows onto the screen, unless it's edited
+    **   first, in which case the rest are placed there and then.
+    **  \param box The box to add.
+    **  \return The handle of the new box.
+    */
+    Box::Handle Restore(const Box &box);
+
+    /*!
+    **  \brief Places any restored boxes that haven't been placed yet.
+    **
+    **  Called before anything that needs the placements or the grid, and by whoever
+    **   restored the pipe if it was off the frame thread (see SceneStreamer), so the
+    **   frames don't have to. Boxes dropped by Truncate() can still be in the grid, see Vacant().
+    */
+    void Settle() const;
+
+    /*!
+    **  \brief Sets the pool used to place long runs of boxes on every core.
+    **
+    **  Placing the boxes after one that moved is a running product of their local matrices.
+    **   Long runs are split into blocks: each block works out its own running product in
+    **   parallel, the blocks are chained together, then each block is moved into place in
+    **   parallel. The grid is updated a shard per job after that. Only finding the boxes
+    **   (a walk down the list) and chaining the blocks are left on the calling thread.
+    **   Pipe edits must not be made from inside a job once this is set.
+    **  \param jobs The pool, or 0 to place everything on the calling thread.
+    */
+    static void UseJobs(JobPool *jobs);
+
+    /*!
+    **  \brief Queues the work of bringing the mesh up to date, so Draw() has nothing left to do.
+    **
+    **  Working out which boxes moved is done here, baking them into the mesh is split into
+    **   jobs of a segment each, so a long pipe is spread over every thread. Safe to run as a
+    **   job itself, as long as nothing else touches the pipe until the jobs are done.
+    **  \param jobs Where to queue the baking.
+    */
+    void Prepare(JobPool &jobs) const;
+
+    /*!
+    **  \brief Checks if the mesh is up to date, so there's no point calling Prepare().
+    **
+    **  \return Returns true if nothing has changed and every box has been placed and baked.
+    */
+    bool Current() const;
+
+    /*!
+    **  \brief Draws every box in the pipe.
+    **
+    **  Each box already knows its transform relative to the head (the running product of
+    **  the local matrices of every box before it), so its world matrix is just the head's
+    **  matrix times that. The world matrices are built on the CPU and baked into a
+    **  PipeMesh, so the whole pipe is drawn with a few draw calls and no matrix stack at all.
+    **
+    **  World matrices are cached, only boxes from the first dirty box onwards are
+    **  recalculated and baked again, so a static pipe costs nothing to transform.
+    **  Faces pressed against a neighbouring box are left out of the mesh (see
+    **  Box::VisibleFaces()), so a straight run draws four faces a box instead of six.
+    **  The boxes are only looked at when something in the pipe might have changed (anything
+    **  non-const was called), so an untouched pipe that's off screen costs one bounds test.
+    **  If Prepare() hasn't been called since the last draw, it's all done here instead.
+    **  Expects the vertex, normal and colour arrays to be enabled.
+    **  \param frustum What the camera can see.
+    **  \param detail When to switch far away parts of the pipe to low detail.
+    */
+    void Draw(const Frustum &frustum, const Detail &detail) const;
+
+protected:
+    MasterBox head;             //!< The head of the pipe.
+    std::vector<Box> boxes;     //!< Pool of boxes, indexed by handle (slot 0 belongs to the head).
+
+    Box::Handle last;           //!< Handle of the last box in the pipe.
+    Box::Handle freeList;       //!< Handle of the first unused slot in the pool.
+    Box::Handle retired;        //!< First slot cut off by Truncate() (Box::NONE if there isn't one), reused once its cell is out of the grid.
+    Box::Handle retiredLast;    //!< Last slot cut off by Truncate(), where the next cut off tail is hooked on.
+
+    mutable Box::Handle dropped;        //!< First retired box that's still in the grid (Box::NONE if there isn't one).
+
+    mutable OccupancyGrid grid;         //!< Cells taken up by the boxes, relative to the head.
+    mutable Box::Handle unplaced;       //!< First restored box that hasn't been placed yet (Box::NONE if they all have).
+
+    mutable PipeMesh mesh;      //!< Every box in the pipe baked into world space.
+    mutable bool stale;         //!< Might the pipe have changed since the mesh was brought up to date?
+    mutable std::size_t restart;    //!< Position of the first box Walk() has to look at again.
+    mutable std::size_t reach;      //!< Position of the last box Walk() has to look at again, if nothing after it moved.
+    mutable bool prepared;      //!< Has Prepare() been called since the last draw?
+    mutable Box::Handle unwalked;   //!< First box Walk() stopped at because it wasn't placed yet (Box::NONE if it got to the end).
+    mutable std::size_t walked;     //!< Number of boxes Walk() got through before stopping.
+    mutable std::size_t active; //!< Position of the active box in the mesh (PipeMesh::NONE if there isn't one).
+    mutable std::vector<Box::Handle> order;     //!< Handles of the boxes by position, as of the last walk.
+    mutable std::vector<std::size_t> positions; //!< Positions of the boxes by handle, as of the last walk (PipeMesh::NONE for boxes added since).
+
+    typedef std::vector<std::vector<OccupancyGrid::Cell> > ShardedCells;   //!< Cells sorted by OccupancyGrid::Shard().
+
+    static JobPool *jobs;               //!< Pool for placing long runs of boxes (0 for none).
+    const static std::size_t SCANBLOCK;    //!< Fewest boxes worth placing as a block of their own.
+    const static std::size_t SETTLEBUDGET; //!< Most restored boxes to place (or dropped boxes to take out of the grid) in one frame.
+
+    /*!
+    **  \brief Stores a box in the pool.
+    **
+    **  \param box The box to store.
+    **  \return The handle of the stored box.
+    */
+    Box::Handle Allocate(const Box &box);
+
+    /*!
+    **  \brief Works out where a box and every box after it are, and moves their cells to match.
+    **
+    **  \param handle Handle of the first box that moved (not the head).
+    */
+    void Place(const Box::Handle &handle);
+
+    /*!
+    **  \brief Places a block of boxes, each relative to the one before it.
+    **
+    **  \param chain Handles of the boxes being placed, in order.
+    **  \param begin Position in the chain of the first box in the block.
+    **  \param end One past the position of the last box in the block.
+    **  \param base The box before the block (Box() to place the block relative to it).
+    **  \param removed Where to note the cells the boxes were in.
+    */
+    void Scan(const std::vector<Box::Handle> &chain, const std::size_t &begin, const std::size_t &end, const Box &base, ShardedCells &removed);
+
+    /*!
+    **  \brief Moves a block placed relative to the box before it into its real place.
+    **
+    **  \param chain Handles of the boxes being placed, in order.
+    **  \param begin Position in the chain of the first box in the block.
+    **  \param end One past the position of the last box in the block.
+    **  \param offset Where the box before the block really is.
+    **  \param added Where to note the cells the boxes end up in.
+    */
+    void Shift(const std::vector<Box::Handle> &chain, const std::size_t &begin, const std::size_t &end, const Box &offset, ShardedCells &added);
+
+    /*!
+    **  \brief Notes the cells a block of boxes is in.
+    **
+    **  \param chain Handles of the boxes, in order.
+    **  \param begin Position in the chain of the first box in the block.
+    **  \param end One past the position of the last box in the block.
+    **  \param cells Where to note the cells.
+    */
+    void Collect(const std::vector<Box::Handle> &chain, const std::size_t &begin, const std::size_t &end, ShardedCells &cells) const;
+
+    /*!
+    **  \brief Moves one shard of the grid from the old cells of a run of boxes to the new ones.
+    **
+    **  \param removed The old cells of each block.
+    **  \param added The new cells of each block.
+    **  \param shard Which shard to update.
+    */
+    void Refile(const std::vector<ShardedCells> &removed, const std::vector<ShardedCells> &added, const std::size_t &shard);
+
+    /*!
+    **  \brief Takes some of the boxes dropped by Truncate() out of the grid.
+    **
+    **  Picks up where the last call left off, in the order the boxes were in the pipe.
+    **  \param budget The most boxes to take out.
+    */
+    void Release(const std::size_t &budget) const;
+
+    /*!
+    **  \brief Checks if a cell is empty, ignoring boxes dropped by Truncate().
+    **
+    **  Only takes dropped boxes out of the grid while the cell looks taken, and the first
+    **   to come out are the ones nearest the end of the pipe, where a new box would go.
+    **  \param cell The cell to check.
+    **  \return Returns true if no box in the pipe is in the cell.
+    */
+    bool Vacant(const OccupancyGrid::Cell &cell) const;
+
+    /*!
+    **  \brief Places some of the restored boxes that haven't been placed yet.
+    **
+    **  \param budget The most boxes to place.
+    */
+    void Settle(const std::size_t &budget) const;
+
+    /*!
+    **  \brief Updates the faces in the mesh, and finds the boxes that need baking again.
+    **
+    **  Starts from the first box that was touched since the last walk (see Touch()), and
+    **   stops after the last one unless something moved. It only goes as far as the boxes
+    **   that have been placed, and the next walk carries on from there, so a pipe that's
+    **   being placed a slice at a time is only walked once all told.
+    **  \return Position of the first box that moved (the mesh size if none did).
+    */
+    std::size_t Walk() const;
+
+    /*!
+    **  \brief Notes that a box may have changed, so Walk() looks at it and its neighbours again.
+    **
+    **  \param handle Handle of the box, looked at before it's unlinked if it's being removed.
+    */
+    void Touch(const Box::Handle &handle);
+
+    /*!
+    **  \brief Notes that a slot has been given to a new box, which hasn't been walked yet.
+    **
+    **  \param handle Handle of the slot.
+    */
+    void Forget(const Box::Handle &handle);
+
+    /*!
+    **  \brief Returns the position of a box in the mesh, as of the last walk.
+    **
+    **  \param handle Handle of the box.
+    **  \return The position, or PipeMesh::NONE if the box hasn't been walked since it was added.
+    */
+    std::size_t Position(const Box::Handle &handle) const;
+
+    /*!
+    **  \brief Bakes a run of boxes into the mesh, found by Walk().
+    **
+    **  \param begin Position of the first box.
+    **  \param end One past the position of the last box.
+    **  \param origin Where the head is (see MasterBox::LocalMatrix()).
+    */
+    void Transform(const std::size_t &begin, const std::size_t &end, const Matrix4 &origin) const;
+};
+#endif
@@ -0,0 +1,540 @@
+#include "PipeMesh.h"
+
+#include "Box.h"
+#include "GLExtensions.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/thread/lock_guard.hpp>
+
+const std::size_t PipeMesh::NONE = static_cast<std::size_t>(-1);
+const std::size_t PipeMesh::SEGMENT = 1024;
+const std::size_t PipeMesh::PROXY = 16;
+
+bool PipeMesh::mergeRuns = true;
+unsigned int PipeMesh::bakeMode = 0;
+std::vector<GLuint> PipeMesh::proxyIndices;
+
+// Pipes held by globals in other files (and by the reclaimer's queue) are destroyed at exit,
+//  in no particular order relative to this file, and every one of them orphans its buffers.
+//  So the orphans and their mutex are allocated once and never freed, which keeps them
+//  around for the last destructor. They're set up before main, so no thread can race to make them.
+std::vector<GLuint> &PipeMesh::orphans = *new std::vector<GLuint>();
+boost::mutex &PipeMesh::orphanMutex = *new boost::mutex();
+
+PipeMesh::PipeMesh():vertices(),faces(),runs(),count(0),triangles(),used(),segmentBounds(),bounds(),boundBegin(NONE),boundEnd(0),proxies(),coarse(),distant(),buffer(0),bufferSize(0),dirtyBegin(NONE),dirtyEnd(0),
+                     indexBuffer(0),indexBufferSize(0),bakeBegin(NONE),bakeEnd(0),baked(bakeMode)
+{
+}
+
+PipeMesh::PipeMesh(const PipeMesh &rhs):vertices(rhs.vertices),faces(rhs.faces),runs(rhs.runs),count(rhs.count),triangles(rhs.triangles),used(rhs.used),
+                                        segmentBounds(rhs.segmentBounds),bounds(rhs.bounds),boundBegin(rhs.boundBegin),boundEnd(rhs.boundEnd),
+                                        proxies(rhs.proxies),coarse(rhs.coarse),distant(),
+                                        buffer(0),bufferSize(0),dirtyBegin(NONE),dirtyEnd(0),
+                                        indexBuffer(0),indexBufferSize(0),bakeBegin(rhs.bakeBegin),bakeEnd(rhs.bakeEnd),baked(rhs.baked)
+{
+}
+
+PipeMesh::~PipeMesh()
+{
+    Orphan();
+}
+
+PipeMesh& PipeMesh::operator=(const PipeMesh &rhs)
+{
+    if(this != &rhs)
+    {
+        Orphan();
+
+        this->vertices = rhs.vertices;
+        this->faces = rhs.faces;
+        this->runs = rhs.runs;
+        this->count = rhs.count;
+        this->triangles = rhs.triangles;
+        this->used = rhs.used;
+        this->segmentBounds = rhs.segmentBounds;
+        this->bounds = rhs.bounds;
+        this->boundBegin = rhs.boundBegin;
+        this->boundEnd = rhs.boundEnd;
+        this->proxies = rhs.proxies;
+        this->coarse = rhs.coarse;
+        this->dirtyBegin = NONE;
+        this->dirtyEnd = 0;
+        this->bakeBegin = rhs.bakeBegin;
+        this->bakeEnd = rhs.bakeEnd;
+        this->baked = rhs.baked;
+    }
+
+    return *this;
+}
+
+std::size_t PipeMesh::Size() const
+{
+    return this->count;
+}
+
+void PipeMesh::Resize(const std::size_t &boxes)
+{
+    if(boxes * 24 > this->vertices.size())
+    {   // The colours never change, so they only need filling in as the mesh grows.
+        std::size_t filled = this->vertices.size();
+
+        this->vertices.resize(boxes * 24);
+
+        for(std::size_t i = filled; i < this->vertices.size(); ++i)
+        {
+            const GLfloat *colour = &Box::colours[(i % 24) * 3];
+
+            this->vertices[i].colour[0] = static_cast<GLubyte>(colour[0] * 255.0f);
+            this->vertices[i].colour[1] = static_cast<GLubyte>(colour[1] * 255.0f);
+            this->vertices[i].colour[2] = static_cast<GLubyte>(colour[2] * 255.0f);
+            this->vertices[i].colour[3] = 255;
+            this->vertices[i].normal[3] = 0;
+        }
+    }
+
+    if(boxes * 36 > this->triangles.size())
+    {   // Segments start SEGMENT boxes apart, but the last one only needs room for the boxes in it.
+        this->triangles.resize(boxes * 36);
+    }
+
+    if(boxes < this->count)
+    {   // The last segment may still have faces from the boxes that were cut off, and any
+        //  segments past it are empty now.
+        this->bakeBegin = std::min(this->bakeBegin, boxes / SEGMENT);
+        this->bakeEnd = std::max(this->bakeEnd, boxes / SEGMENT + 1);
+
+        std::fill(this->used.begin() + std::min(this->used.size(), (boxes + SEGMENT - 1) / SEGMENT), this->used.end(), 0);
+
+        // Same goes for the bounds.
+        this->boundBegin = std::min(this->boundBegin, boxes / SEGMENT);
+        this->boundEnd = std::max(this->boundEnd, Segments());
+    }
+
+    // Shrinking just draws less of the mesh, the memory is kept for when the pipe grows again.
+    this->faces.resize(boxes, 0);
+    this->runs.resize(boxes, Box::NOFACE);
+    this->count = boxes;
+    this->dirtyEnd = std::min(this->dirtyEnd, boxes);
+
+    if(Segments() > this->used.size())
+    {
+        this->used.resize(Segments(), 0);
+        this->segmentBounds.resize(Segments());
+        this->proxies.resize(Segments() * (SEGMENT / PROXY) * 24);
+        this->coarse.resize(Segments(), 0);
+    }
+}
+
+void PipeMesh::Transform(const std::size_t &index, const Matrix4 &world)
+{
+    Vertex *vertex = &this->vertices[index * 24];
+
+    for(int i = 0; i < 24; ++i)
+    {   // Boxes are only ever rotated and translated, so the normals can use the same matrix.
+        Vector3 v = world.TransformPoint(Vector3(Box::vertices[i * 3], Box::vertices[i * 3 + 1], Box::vertices[i * 3 + 2]));
+        Vector3 n = world.TransformVector(Vector3(Box::normals[i * 3], Box::normals[i * 3 + 1], Box::normals[i * 3 + 2]));
+
+        vertex[i].position[0] = v.x;
+        vertex[i].position[1] = v.y;
+        vertex[i].position[2] = v.z;
+
+        vertex[i].normal[0] = static_cast<GLbyte>(floor(n.x * 127.0f + 0.5f));
+        vertex[i].normal[1] = static_cast<GLbyte>(floor(n.y * 127.0f + 0.5f));
+        vertex[i].normal[2] = static_cast<GLbyte>(floor(n.z * 127.0f + 0.5f));
+    }
+}
+
+void PipeMesh::Moved(const std::size_t &begin, const std::size_t &end)
+{
+    if(begin >= end)
+    {
+        return;
+    }
+
+    this->dirtyBegin = std::min(this->dirtyBegin, begin);
+    this->dirtyEnd = std::max(this->dirtyEnd, end);
+
+    this->boundBegin = std::min(this->boundBegin, begin / SEGMENT);
+    this->boundEnd = std::max(this->boundEnd, (end - 1) / SEGMENT + 1);
+}
+
+void PipeMesh::SetFaces(const std::size_t &index, const GLubyte &faces, const int &continues)
+{
+    if(this->faces[index] != faces || this->runs[index] != continues)
+    {
+        this->faces[index] = faces;
+        this->runs[index] = static_cast<GLbyte>(continues);
+
+        this->bakeBegin = std::min(this->bakeBegin, index / SEGMENT);
+        this->bakeEnd = std::max(this->bakeEnd, index / SEGMENT + 1);
+    }
+}
+
+const BoundingBox& PipeMesh::Bounds()
+{
+    Rebound();
+
+    return this->bounds;
+}
+
+void PipeMesh::Draw(const std::size_t &active, const Frustum &frustum, const Detail &detail)
+{
+    if(this->count == 0)
+    {
+        return;
+    }
+
+    const Frustum::Result visible = frustum.Test(Bounds());
+
+    if(visible == Frustum::OUTSIDE)
+    {   // Anything baked since the last draw keeps until the mesh is back in view.
+        return;
+    }
+
+    if(this->baked != bakeMode)
+    {   // Merging was switched on or off, build everything again.
+        this->baked = bakeMode;
+        this->bakeBegin = 0;
+        this->bakeEnd = Segments();
+    }
+
+    Bake();
+
+    const char *base = reinterpret_cast<const char*>(&this->vertices[0]);
+    const char *elements = reinterpret_cast<const char*>(&this->triangles[0]);
+
+    if(GLExtensions::HasVertexBuffers())
+    {   // Offsets into the bound buffers rather than pointers.
+        Upload();
+
+        GLExtensions::glBindBuffer(GL_ARRAY_BUFFER, this->buffer);
+        GLExtensions::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->indexBuffer);
+
+        base = 0;
+        elements = 0;
+    }
+
+    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, position));
+    glNormalPointer(GL_BYTE, sizeof(Vertex), base + offsetof(Vertex, normal));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), base + offsetof(Vertex, colour));
+
+    this->distant.clear();
+
+    for(std::size_t i = 0; i < Segments(); ++i)
+    {
+        if(this->used[i] == 0 || (visible != Frustum::INSIDE && frustum.Test(this->segmentBounds[i]) == Frustum::OUTSIDE))
+        {
+            continue;
+        }
+
+        // Segments that have merged down to fewer triangles than their proxies stay as they are.
+        std::size_t groups = (std::min(this->count, (i + 1) * SEGMENT) - i * SEGMENT + PROXY - 1) / PROXY;
+
+        this->coarse[i] = (groups * 36 < this->used[i]) && detail.Coarse(this->segmentBounds[i], this->coarse[i] != 0);
+
+        if(this->coarse[i])
+        {   // Drawn below, once the buffers are out of the way.
+            this->distant.push_back(i);
+        }
+        else
+        {
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(this->used[i]), GL_UNSIGNED_INT, elements + i * SEGMENT * 36 * sizeof(GLuint));
+        }
+    }
+
+    if(active < this->count)
+    {   // Draw the active box as lines so the user can see what's selected.
+        glDrawArrays(GL_LINES, static_cast<GLint>(active * 24), 24);
+    }
+
+    if(GLExtensions::HasVertexBuffers())
+    {   // Leave things how we found them for anything drawn with plain vertex arrays.
+        GLExtensions::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        GLExtensions::glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    if(this->distant.empty())
+    {
+        return;
+    }
+
+    if(proxyIndices.empty())
+    {   // Every segment's proxies are laid out the same way, so they can share the indices.
+        proxyIndices.resize((SEGMENT / PROXY) * 36);
+
+        for(std::size_t i = 0; i < proxyIndices.size(); ++i)
+        {
+            proxyIndices[i] = static_cast<GLuint>((i / 36) * 24 + Box::indices[i % 36]);
+        }
+    }
+
+    for(std::vector<std::size_t>::const_iterator it = this->distant.begin(); it != this->distant.end(); ++it)
+    {   // The proxies are small enough to send from client memory each time.
+        const Vertex *proxy = &this->proxies[*it * (SEGMENT / PROXY) * 24];
+        std::size_t groups = (std::min(this->count, (*it + 1) * SEGMENT) - *it * SEGMENT + PROXY - 1) / PROXY;
+
+        glVertexPointer(3, GL_FLOAT, sizeof(Vertex), proxy->position);
+        glNormalPointer(GL_BYTE, sizeof(Vertex), proxy->normal);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), proxy->colour);
+
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(groups * 36), GL_UNSIGNED_INT, &proxyIndices[0]);
+    }
+}
+
+void PipeMesh::DeleteOrphans()
+{
+    boost::lock_guard<boost::mutex> lock(orphanMutex);
+
+    if(!orphans.empty())
+    {
+        GLExtensions::glDeleteBuffers(static_cast<GLsizei>(orphans.size()), &orphans[0]);
+        orphans.clear();
+    }
+}
+
+void PipeMesh::MergeRuns(const bool &merge)
+{
+    if(merge != mergeRuns)
+    {
+        mergeRuns = merge;
+        ++bakeMode;
+    }
+}
+
+bool PipeMesh::MergingRuns()
+{
+    return mergeRuns;
+}
+
+std::size_t PipeMesh::Segments() const
+{
+    return (this->count + SEGMENT - 1) / SEGMENT;
+}
+
+void PipeMesh::Rebound()
+{
+    if(this->boundBegin >= this->boundEnd)
+    {   // Nothing moved.
+        return;
+    }
+
+    for(std::size_t i = this->boundBegin; i < std::min(this->boundEnd, this->segmentBounds.size()); ++i)
+    {   // The corners of a box are all in its 24 vertices, so there's no need to look at the boxes themselves.
+        BoundingBox segment;
+        std::size_t last = std::min(this->count, (i + 1) * SEGMENT);
+
+        for(std::size_t first = i * SEGMENT; first < last; first += PROXY)
+        {
+            BoundingBox group;
+
+            for(std::size_t v = first * 24; v < std::min(last, first + PROXY) * 24; ++v)
+            {
+                group.Add(Vector3(this->vertices[v].position[0], this->vertices[v].position[1], this->vertices[v].position[2]));
+            }
+
+            Proxy(first / PROXY, group);
+            segment.Add(group);
+        }
+
+        this->segmentBounds[i] = segment;
+    }
+
+    this->boundBegin = NONE;
+    this->boundEnd = 0;
+
+    // There's one segment for every thousand or so boxes, so this is cheap next to the above.
+    this->bounds = BoundingBox();
+
+    for(std::size_t i = 0; i < Segments(); ++i)
+    {
+        this->bounds.Add(this->segmentBounds[i]);
+    }
+}
+
+void PipeMesh::Proxy(const std::size_t &group, const BoundingBox &bounds)
+{
+    const Vertex *first = &this->vertices[group * PROXY * 24];
+    Vertex *proxy = &this->proxies[group * 24];
+    Vector3 extent = bounds.upper - bounds.lower;
+
+    for(int face = 0; face < 6; ++face)
+    {
+        const Vertex *match = first;
+        int best = -128 * 128;
+
+        for(int side = 0; side < 6; ++side)
+        {   // Normals are scaled to 127, so this is 127 times the cosine between them.
+            const GLbyte *normal = first[side * 4].normal;
+            int along = static_cast<int>(normal[0] * Box::normals[face * 12] + normal[1] * Box::normals[face * 12 + 1] + normal[2] * Box::normals[face * 12 + 2]);
+
+            if(along > best)
+            {
+                best = along;
+                match = &first[side * 4];
+            }
+        }
+
+        for(int corner = face * 4; corner < face * 4 + 4; ++corner)
+        {
+            proxy[corner].position[0] = bounds.lower.x + (Box::vertices[corner * 3] + 0.5f) * extent.x;
+            proxy[corner].position[1] = bounds.lower.y + (Box::vertices[corner * 3 + 1] + 0.5f) * extent.y;
+            proxy[corner].position[2] = bounds.lower.z + (Box::vertices[corner * 3 + 2] + 0.5f) * extent.z;
+
+            proxy[corner].normal[0] = static_cast<GLbyte>(Box::normals[corner * 3] * 127.0f);
+            proxy[corner].normal[1] = static_cast<GLbyte>(Box::normals[corner * 3 + 1] * 127.0f);
+            proxy[corner].normal[2] = static_cast<GLbyte>(Box::normals[corner * 3 + 2] * 127.0f);
+            proxy[corner].normal[3] = 0;
+
+            std::copy(match->colour, match->colour + 4, proxy[corner].colour);
+        }
+    }
+}
+
+void PipeMesh::Bake()
+{
+    std::size_t end = std::min(this->bakeEnd, Segments());
+
+    for(std::size_t i = this->bakeBegin; i < end; ++i)
+    {   // Two triangles for every face that can be seen, packed at the start of the segment.
+        std::size_t last = std::min(this->count, (i + 1) * SEGMENT);
+        GLuint *index = &this->triangles[i * SEGMENT * 36];
+
+        for(std::size_t box = i * SEGMENT, run = box + 1; box < last; box = run, run = box + 1)
+        {
+            int along = (mergeRuns && run < last) ? this->runs[run] : Box::NOFACE;
+
+            if(along != Box::NOFACE)
+            {   // Every box carrying on in the same direction faces the same way.
+                while(run < last && this->runs[run] == along)
+                {
+                    ++run;
+                }
+            }
+
+            index = BakeRun(index, box, run, along);
+        }
+
+        this->used[i] = index - &this->triangles[i * SEGMENT * 36];
+    }
+
+    if(GLExtensions::HasVertexBuffers())
+    {
+        if(this->indexBuffer == 0)
+        {
+            GLExtensions::glGenBuffers(1, &this->indexBuffer);
+            this->indexBufferSize = 0;
+        }
+
+        GLExtensions::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->indexBuffer);
+
+        if(this->indexBufferSize < this->count)
+        {   // Not enough room, reallocate it with room to grow (and upload everything while we're at it).
+            this->indexBufferSize = this->triangles.capacity() / 36;
+
+            GLExtensions::glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indexBufferSize * 36 * sizeof(GLuint), 0, GL_DYNAMIC_DRAW);
+            GLExtensions::glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, this->count * 36 * sizeof(GLuint), &this->triangles[0]);
+        }
+        else
+        {
+            for(std::size_t i = this->bakeBegin; i < end; ++i)
+            {
+                GLExtensions::glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+                                              i * SEGMENT * 36 * sizeof(GLuint),
+                                              this->used[i] * sizeof(GLuint),
+                                              &this->triangles[i * SEGMENT * 36]);
+            }
+        }
+
+        GLExtensions::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    this->bakeBegin = NONE;
+    this->bakeEnd = 0;
+}
+
+GLuint* PipeMesh::BakeRun(GLuint *index, const std::size_t &first, const std::size_t &end, const int &along) const
+{
+    for(int face = 0; face < 6; ++face)
+    {   // The sides of a run are all in the same plane, the ends aren't.
+        bool side = (along != Box::NOFACE) && (face % 3 != along % 3);
+
+        for(std::size_t box = first, last = first; box < end; box = last + 1, last = box)
+        {
+            if(!(this->faces[box] & (1 << face)))
+            {
+                continue;
+            }
+
+            while(side && last + 1 < end && (this->faces[last + 1] & (1 << face)))
+            {
+                ++last;
+            }
+
+            for(int j = face * 6; j < face * 6 + 6; ++j)
+            {   // Corners towards the end of the run come from the last box, the rest from the first.
+                int corner = Box::indices[j];
+                bool ahead = side && (Box::vertices[corner * 3 + along % 3] * ((along < 3) ? 1.0f : -1.0f) > 0.0f);
+
+                *index++ = static_cast<GLuint>((ahead ? last : box) * 24 + corner);
+            }
+        }
+    }
+
+    return index;
+}
+
+void PipeMesh::Upload()
+{
+    if(this->buffer == 0)
+    {
+        GLExtensions::glGenBuffers(1, &this->buffer);
+        this->bufferSize = 0;
+    }
+
+    GLExtensions::glBindBuffer(GL_ARRAY_BUFFER, this->buffer);
+
+    if(this->bufferSize < this->count)
+    {   // Not enough room, reallocate it with room to grow (and upload everything while we're at it).
+        this->bufferSize = this->vertices.capacity() / 24;
+
+        GLExtensions::glBufferData(GL_ARRAY_BUFFER, this->bufferSize * 24 * sizeof(Vertex), 0, GL_DYNAMIC_DRAW);
+        GLExtensions::glBufferSubData(GL_ARRAY_BUFFER, 0, this->count * 24 * sizeof(Vertex), &this->vertices[0]);
+    }
+    else if(this->dirtyBegin < this->dirtyEnd)
+    {
+        GLExtensions::glBufferSubData(GL_ARRAY_BUFFER,
+                                      this->dirtyBegin * 24 * sizeof(Vertex),
+                                      (this->dirtyEnd - this->dirtyBegin) * 24 * sizeof(Vertex),
+                                      &this->vertices[this->dirtyBegin * 24]);
+    }
+
+    GLExtensions::glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    this->dirtyBegin = NONE;
+    this->dirtyEnd = 0;
+}
+
+void PipeMesh::Orphan()
+{
+    if(this->buffer != 0 || this->indexBuffer != 0)
+    {
+        boost::lock_guard<boost::mutex> lock(orphanMutex);
+
+        if(this->buffer != 0)
+        {
+            orphans.push_back(this->buffer);
+        }
+
+        if(this->indexBuffer != 0)
+        {
+            orphans.push_back(this->indexBuffer);
+        }
+    }
+
+    this->buffer = 0;
+    this->bufferSize = 0;
+    this->indexBuffer = 0;
+    this->indexBufferSize = 0;
+}
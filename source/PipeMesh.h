@@ -0,0 +1,259 @@
+/*!
+**  \file PipeMesh.h
+**  \brief Defines the PipeMesh class
+**
+**  \author Andrew James
+**  \sa PipeMesh
+*/
+#ifndef __PipeMesh
+#define __PipeMesh
+
+#include "BoundingBox.h"
+#include "Detail.h"
+#include "Frustum.h"
+#include "Matrix4.h"
+
+#include <vector>
+#include <cstddef>
+
+#include <boost/thread/mutex.hpp>
+
+#include <SDL_OpenGL.h>
+
+/*!
+**  \class PipeMesh
+**  \brief Every box in a pipe baked into one vertex buffer.
+**
+**  Drawing a box at a time costs a draw call and a matrix push/pop per box. Instead each
+**   box's world matrix is applied to the unit cube once, when the box moves, and the whole
+**   pipe goes to OpenGL in one glDrawElements call per segment.
+**  Boxes are stored in the order they appear in the pipe, 24 interleaved vertices each.
+**   Vertices live in a buffer object on the GPU (when the driver has them), and only the
+**   boxes baked since the last draw are uploaded again.
+**  Faces hidden inside the pipe are left out of the index buffer. The index buffer is split
+**   into segments of SEGMENT boxes, and changing which faces a box shows only rebuilds the
+**   indices for its own segment.
+**  Boxes in a straight run all face the same way, so the sides of the run are flat strips
+**   of the same colour. When MergeRuns() is on (the default) each strip is drawn as one
+**   stretched quad between the first and last box of the strip, greedy meshing style. No
+**   extra vertices are needed, the quad just uses the end vertices of the two boxes.
+**   Runs don't cross segments, so a segment can still be rebuilt on its own.
+**  Each segment keeps a bounding box, and so does the whole mesh. A mesh that's off screen
+**   is skipped after one test, and otherwise only the segments in view are drawn.
+**  Far away segments are drawn in low detail (see Detail), as one box around every PROXY
+**   boxes. The proxies are worked out along with the bounds, so only segments that moved
+**   get new ones.
+*/
+class PipeMesh
+{
+public:
+    /*!
+    **  \struct Vertex
+    **  \brief A compact interleaved vertex (20 bytes, where three float arrays took 36).
+    */
+    struct Vertex
+    {
+        GLfloat position[3];    //!< World space position.
+        GLbyte normal[4];       //!< World space normal scaled to [-127, 127] (the last byte is padding).
+        GLubyte colour[4];      //!< RGBA colour.
+    };
+
+    const static std::size_t NONE;      //!< Index that doesn't refer to any box.
+    const static std::size_t SEGMENT;   //!< Number of boxes in each segment of the index buffer.
+    const static std::size_t PROXY;     //!< Number of boxes covered by each box in low detail.
+
+    /*!
+    **  \brief Creates an empty mesh.
+    */
+    PipeMesh();
+
+    /*!
+    **  \brief Copies the baked vertices, the copy gets its own buffer object on its first draw.
+    **
+    **  \param rhs PipeMesh to copy.
+    */
+    PipeMesh(const PipeMesh &rhs);
+
+    /*!
+    **  \brief Queues the buffer object to be deleted, see DeleteOrphans().
+    */
+    ~PipeMesh();
+
+    /*!
+    **  \brief Copies the baked vertices, the copy gets its own buffer object on its first draw.
+    **
+    **  \param rhs PipeMesh to copy.
+    **  \return A reference to self.
+    */
+    PipeMesh& operator=(const PipeMesh &rhs);
+
+    /*!
+    **  \brief Returns the number of boxes in the mesh.
+    **
+    **  \return The number of boxes.
+    */
+    std::size_t Size() const;
+
+    /*!
+    **  \brief Sets the number of boxes in the mesh.
+    **
+    **  New boxes are garbage until Transform() is called for them, and have no faces until
+    **   SetFaces() is called for them.
+    **  \param boxes The number of boxes.
+    */
+    void Resize(const std::size_t &boxes);
+
+    /*!
+    **  \brief Bakes a box into the mesh.
+    **
+    **  Only writes the box's own vertices, so different boxes can be baked on different
+    **   threads at once. Tell the mesh which boxes were baked with Moved() afterwards.
+    **  \param index Position of the box in the pipe.
+    **  \param world World matrix of the box.
+    */
+    void Transform(const std::size_t &index, const Matrix4 &world);
+
+    /*!
+    **  \brief Marks baked boxes to be uploaded, and their segments to get new bounds.
+    **
+    **  \param begin The first box baked.
+    **  \param end One past the last box baked.
+    */
+    void Moved(const std::size_t &begin, const std::size_t &end);
+
+    /*!
+    **  \brief Sets which faces of a box get drawn, and whether they can be merged with the previous box.
+    **
+    **  The segment holding the box is only rebuilt if something actually changed.
+    **  \param index Position of the box in the pipe.
+    **  \param faces Face mask, see Box::VisibleFaces().
+    **  \param continues Face of the previous box this box carries straight on from, see Box::Continues().
+    */
+    void SetFaces(const std::size_t &index, const GLubyte &faces, const int &continues);
+
+    /*!
+    **  \brief Returns the bounding box of every box in the mesh.
+    **
+    **  \return The bounds of the mesh (empty if there are no boxes).
+    */
+    const BoundingBox& Bounds();
+
+    /*!
+    **  \brief Uploads anything baked since the last draw, then draws the parts of the mesh in view.
+    **
+    **  The active box is drawn as lines, the rest as triangles (give the active box no faces
+    **   with SetFaces()). Nothing is baked or uploaded while the whole mesh is out of view, it
+    **   waits until the mesh comes back. Expects the vertex, normal and colour arrays to be enabled.
+    **  \param active Position of the active box in the pipe, PipeMesh::NONE if it isn't in this pipe.
+    **  \param frustum What the camera can see.
+    **  \param detail Which segments are far enough away to draw in low detail.
+    */
+    void Draw(const std::size_t &active, const Frustum &frustum, const Detail &detail);
+
+    /*!
+    **  \brief Deletes the buffer objects of destroyed meshes.
+    **
+    **  Meshes can be destroyed on any thread (see PipeReclaimer), but buffers can only be
+    **   deleted on the thread that owns the OpenGL context, so call this from there.
+    */
+    static void DeleteOrphans();
+
+    /*!
+    **  \brief Turns merging the faces of straight runs on or off.
+    **
+    **  Every mesh is rebuilt on its next draw.
+    **  \param merge Should straight runs be merged?
+    */
+    static void MergeRuns(const bool &merge);
+
+    /*!
+    **  \brief Checks if the faces of straight runs are being merged.
+    **
+    **  \return Returns true if straight runs are merged.
+    */
+    static bool MergingRuns();
+
+protected:
+    std::vector<Vertex> vertices;   //!< World space vertices, 24 per box.
+    std::vector<GLubyte> faces;     //!< Visible faces of each box.
+    std::vector<GLbyte> runs;       //!< Face of the previous box each box carries straight on from (Box::NOFACE if it doesn't).
+    std::size_t count;              //!< The number of boxes in the mesh.
+
+    std::vector<GLuint> triangles;  //!< Indices of the visible faces, 36 per box, each segment starting at its first box.
+    std::vector<std::size_t> used;  //!< Number of indices used in each segment.
+
+    std::vector<BoundingBox> segmentBounds; //!< Bounds of the boxes in each segment.
+    BoundingBox bounds;                     //!< Bounds of every box.
+    std::size_t boundBegin;                 //!< First segment whose bounds need working out again.
+    std::size_t boundEnd;                   //!< One past the last segment whose bounds need working out again.
+
+    std::vector<Vertex> proxies;            //!< Low detail boxes, 24 vertices for every PROXY boxes.
+    std::vector<GLubyte> coarse;            //!< Is each segment in low detail?
+    std::vector<std::size_t> distant;       //!< Segments to draw in low detail this frame (kept to save allocating every frame).
+
+    GLuint buffer;                  //!< The vertex buffer object (0 until the first draw).
+    std::size_t bufferSize;         //!< Number of boxes the vertex buffer object has room for.
+    std::size_t dirtyBegin;         //!< First box baked since the last upload.
+    std::size_t dirtyEnd;           //!< One past the last box baked since the last upload.
+
+    GLuint indexBuffer;             //!< The index buffer object (0 until the first draw).
+    std::size_t indexBufferSize;    //!< Number of boxes the index buffer object has room for.
+    std::size_t bakeBegin;          //!< First segment whose indices need rebuilding.
+    std::size_t bakeEnd;            //!< One past the last segment whose indices need rebuilding.
+    unsigned int baked;             //!< Value of bakeMode when the indices were last built.
+
+    static bool mergeRuns;                  //!< Are the faces of straight runs merged?
+    static unsigned int bakeMode;           //!< Bumped whenever mergeRuns changes, so every mesh knows to rebuild.
+    static std::vector<GLuint> &orphans;    //!< Buffers from destroyed meshes waiting to be deleted (never freed, see PipeMesh.cpp).
+    static std::vector<GLuint> proxyIndices;    //!< Indices of the faces of a segment's worth of proxies.
+    static boost::mutex &orphanMutex;       //!< Guards the orphans (never freed, see PipeMesh.cpp).
+
+    /*!
+    **  \brief Returns the number of segments the boxes take up.
+    **
+    **  \return The number of segments.
+    */
+    std::size_t Segments() const;
+
+    /*!
+    **  \brief Works out the bounds and proxies of every segment whose boxes moved, and the bounds of the whole mesh.
+    */
+    void Rebound();
+
+    /*!
+    **  \brief Builds the low detail box for a group of PROXY boxes.
+    **
+    **  The faces take their colours from the faces of the first box in the group that point
+    **   the same way, so a straight run looks about the same either way.
+    **  \param group Which group of boxes.
+    **  \param bounds Bounds of the boxes in the group.
+    */
+    void Proxy(const std::size_t &group, const BoundingBox &bounds);
+
+    /*!
+    **  \brief Rebuilds the indices of every segment whose faces changed and uploads them.
+    */
+    void Bake();
+
+    /*!
+    **  \brief Builds the indices for a straight run of boxes.
+    **
+    **  \param index Where to write the indices.
+    **  \param first The first box in the run.
+    **  \param end One past the last box in the run.
+    **  \param along Face of the first box the run heads out of, Box::NOFACE for a single box.
+    **  \return One past the last index written.
+    */
+    GLuint* BakeRun(GLuint *index, const std::size_t &first, const std::size_t &end, const int &along) const;
+
+    /*!
+    **  \brief Copies anything baked since the last upload into the vertex buffer object.
+    */
+    void Upload();
+
+    /*!
+    **  \brief Hands the buffer objects over to DeleteOrphans().
+    */
+    void Orphan();
+};
+#endif
@@ -0,0 +1,63 @@
+#include "PipeReclaimer.h"
+
+PipeReclaimer::PipeReclaimer():queue(),mutex(),pending(),running(true),worker(&PipeReclaimer::Run, this)
+{
+}
+
+PipeReclaimer::~PipeReclaimer()
+{
+    {
+        boost::lock_guard<boost::mutex> lock(this->mutex);
+        this->running = false;
+    }
+
+    this->pending.notify_one();
+    this->worker.join();
+}
+
+void PipeReclaimer::Reclaim(std::list<Pipe> &pipes, const std::list<Pipe>::iterator &pipe)
+{
+    {
+        boost::lock_guard<boost::mutex> lock(this->mutex);
+        this->queue.splice(this->queue.end(), pipes, pipe);
+    }
+
+    this->pending.notify_one();
+}
+
+void PipeReclaimer::Reclaim(std::list<Pipe> &pipes)
+{
+    {
+        boost::lock_guard<boost::mutex> lock(this->mutex);
+        this->queue.splice(this->queue.end(), pipes);
+    }
+
+    this->pending.notify_one();
+}
+
+void PipeReclaimer::Run()
+{
+    while(true)
+    {
+        std::list<Pipe> doomed;
+
+        {
+            boost::unique_lock<boost::mutex> lock(this->mutex);
+
+            while(this->running && this->queue.empty())
+            {
+                this->pending.wait(lock);
+            }
+
+            if(this->queue.empty())
+            {   // Only get here when we've been told to stop and there's nothing left to free.
+                return;
+            }
+
+            doomed.swap(this->queue);
+        }
+
+        // doomed goes out of scope here, outside the lock, so the frame thread
+        //  never waits on a free to queue up another pipe.
+    }
+}
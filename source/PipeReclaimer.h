@@ -0,0 +1,77 @@
+/*!
+**  \file PipeReclaimer.h
+**  \brief Defines the PipeReclaimer class
+**
+**  \author Andrew James
+**  \sa PipeReclaimer
+*/
+#ifndef __PipeReclaimer
+#define __PipeReclaimer
+
+#include "Pipe.h"
+
+#include <list>
+
+#include <boost/thread.hpp>
+
+/*!
+**  \class PipeReclaimer
+**  \brief Frees dropped pipes on a background thread.
+**
+**  Freeing the pool of a pipe with a million boxes in it takes long enough to cause a
+**   hitch, so dropped pipes are spliced onto a queue instead (which is constant time)
+**   and a worker thread throws them away when it gets around to it.
+*/
+class PipeReclaimer
+{
+public:
+    /*!
+    **  \brief Creates the reclaimer and starts the worker thread.
+    */
+    PipeReclaimer();
+
+    /*!
+    **  \brief Frees anything still queued and stops the worker thread.
+    */
+    ~PipeReclaimer();
+
+    /*!
+    **  \brief Removes a pipe from a list and queues it to be freed.
+    **
+    **  The pipe is spliced out of the list, so nothing is copied or freed on the calling thread.
+    **  \param pipes The list holding the pipe.
+    **  \param pipe The pipe to drop. Iterators to it are invalid once this returns.
+    */
+    void Reclaim(std::list<Pipe> &pipes, const std::list<Pipe>::iterator &pipe);
+
+    /*!
+    **  \brief Removes every pipe from a list and queues them to be freed.
+    **
+    **  \param pipes The list of pipes to drop, empty once this returns.
+    */
+    void Reclaim(std::list<Pipe> &pipes);
+
+protected:
+    std::list<Pipe> queue;              //!< Pipes waiting to be freed.
+    boost::mutex mutex;                 //!< Guards the queue and the running flag.
+    boost::condition_variable pending;  //!< Signalled when something is queued (or we're shutting down).
+    bool running;                       //!< Set to false to stop the worker thread.
+    boost::thread worker;               //!< The thread that does the freeing (declared last so it starts last).
+
+    /*!
+    **  \brief Worker thread loop, frees queued pipes until told to stop.
+    */
+    void Run();
+
+private:
+    /*!
+    **  \brief Copy constructor is not allowed, the worker thread belongs to one reclaimer.
+    */
+    PipeReclaimer(const PipeReclaimer &rhs);
+
+    /*!
+    **  \brief Assignment operator is not allowed, the worker thread belongs to one reclaimer.
+    */
+    PipeReclaimer& operator=(const PipeReclaimer &rhs);
+};
+#endif
@@ -0,0 +1,270 @@
+#include "PointBuffer.h"
+#include "Simd.h"
+
+#include <algorithm>
+
+PointBuffer::PointBuffer(void):memory(0), x(0), y(0), z(0), size(0), stride(0)
+{
+}
+
+PointBuffer::PointBuffer(const std::size_t &size):memory(0), x(0), y(0), z(0), size(0), stride(0)
+{
+    this->Resize(size);
+}
+
+PointBuffer::PointBuffer(const PointBuffer &rhs):memory(0), x(0), y(0), z(0), size(0), stride(0)
+{
+    *this = rhs;
+}
+
+PointBuffer::~PointBuffer()
+{
+    delete[] this->memory;
+}
+
+PointBuffer& PointBuffer::operator=(const PointBuffer &rhs)
+{
+    if(this != &rhs)
+    {
+        this->Resize(rhs.size);
+
+        std::copy(rhs.x, rhs.x + rhs.size, this->x);
+        std::copy(rhs.y, rhs.y + rhs.size, this->y);
+        std::copy(rhs.z, rhs.z + rhs.size, this->z);
+    }
+
+    return *this;
+}
+
+std::size_t PointBuffer::Size() const
+{
+    return this->size;
+}
+
+void PointBuffer::Resize(const std::size_t &size)
+{
+    const std::size_t padded = (size + 3) & ~static_cast<std::size_t>(3);
+
+    if(padded > this->stride)
+    {   // Three floats spare so the arrays can start on a 16 byte boundary wherever new puts them.
+        float *memory = new float[padded * 3 + 3];
+        float *x = memory + ((16 - (reinterpret_cast<std::size_t>(memory) & 15)) & 15) / sizeof(float);
+        const std::size_t kept = std::min(this->size, size);
+
+        std::fill(x, x + padded * 3, 0.0f);
+        std::copy(this->x, this->x + kept, x);
+        std::copy(this->y, this->y + kept, x + padded);
+        std::copy(this->z, this->z + kept, x + padded * 2);
+
+        delete[] this->memory;
+        this->memory = memory;
+        this->x = x;
+        this->y = x + padded;
+        this->z = x + padded * 2;
+        this->stride = padded;
+    }
+    else if(size > this->size)
+    {   // The kernels write junk into the padding, so clear what's being reused.
+        std::fill(this->x + this->size, this->x + size, 0.0f);
+        std::fill(this->y + this->size, this->y + size, 0.0f);
+        std::fill(this->z + this->size, this->z + size, 0.0f);
+    }
+
+    this->size = size;
+}
+
+void PointBuffer::Set(const std::size_t &index, const Vector3 &point)
+{
+    this->x[index] = point.x;
+    this->y[index] = point.y;
+    this->z[index] = point.z;
+}
+
+const Vector3 PointBuffer::Get(const std::size_t &index) const
+{
+    return Vector3(this->x[index], this->y[index], this->z[index]);
+}
+
+float* PointBuffer::X()
+{
+    return this->x;
+}
+
+const float* PointBuffer::X() const
+{
+    return this->x;
+}
+
+float* PointBuffer::Y()
+{
+    return this->y;
+}
+
+const float* PointBuffer::Y() const
+{
+    return this->y;
+}
+
+float* PointBuffer::Z()
+{
+    return this->z;
+}
+
+const float* PointBuffer::Z() const
+{
+    return this->z;
+}
+
+void PointBuffer::Translate(const Vector3 &offset)
+{
+    const Simd::Float4 ox = Simd::Splat(offset.x), oy = Simd::Splat(offset.y), oz = Simd::Splat(offset.z);
+    const std::size_t padded = this->Padded();
+
+    for(std::size_t i = 0; i < padded; i += 4)
+    {
+        Simd::Store(this->x + i, Simd::Add(Simd::Load(this->x + i), ox));
+        Simd::Store(this->y + i, Simd::Add(Simd::Load(this->y + i), oy));
+        Simd::Store(this->z + i, Simd::Add(Simd::Load(this->z + i), oz));
+    }
+}
+
+void PointBuffer::Rotate(const Quaternion &rotation)
+{   // v + w * t + xyz x t, with t = 2 * (xyz x v), see Quaternion::Rotate().
+    const Simd::Float4 qx = Simd::Splat(rotation.xyz.x), qy = Simd::Splat(rotation.xyz.y), qz = Simd::Splat(rotation.xyz.z);
+    const Simd::Float4 qw = Simd::Splat(rotation.w), two = Simd::Splat(2.0f);
+    const std::size_t padded = this->Padded();
+
+    for(std::size_t i = 0; i < padded; i += 4)
+    {
+        const Simd::Float4 vx = Simd::Load(this->x + i), vy = Simd::Load(this->y + i), vz = Simd::Load(this->z + i);
+        const Simd::Float4 tx = Simd::Mul(two, Simd::Sub(Simd::Mul(qy, vz), Simd::Mul(qz, vy)));
+        const Simd::Float4 ty = Simd::Mul(two, Simd::Sub(Simd::Mul(qz, vx), Simd::Mul(qx, vz)));
+        const Simd::Float4 tz = Simd::Mul(two, Simd::Sub(Simd::Mul(qx, vy), Simd::Mul(qy, vx)));
+
+        Simd::Store(this->x + i, Simd::Add(Simd::Add(vx, Simd::Mul(qw, tx)), Simd::Sub(Simd::Mul(qy, tz), Simd::Mul(qz, ty))));
+        Simd::Store(this->y + i, Simd::Add(Simd::Add(vy, Simd::Mul(qw, ty)), Simd::Sub(Simd::Mul(qz, tx), Simd::Mul(qx, tz))));
+        Simd::Store(this->z + i, Simd::Add(Simd::Add(vz, Simd::Mul(qw, tz)), Simd::Sub(Simd::Mul(qx, ty), Simd::Mul(qy, tx))));
+    }
+}
+
+void PointBuffer::Transform(const Matrix4 &matrix)
+{
+    Simd::Float4 m[12];
+    const std::size_t padded = this->Padded();
+
+    for(int i = 0; i < 12; ++i)
+    {   // The bottom row of a transform is always (0, 0, 0, 1), so it's left out.
+        m[i] = Simd::Splat(matrix.m[(i / 3) * 4 + i % 3]);
+    }
+
+    for(std::size_t i = 0; i < padded; i += 4)
+    {
+        const Simd::Float4 vx = Simd::Load(this->x + i), vy = Simd::Load(this->y + i), vz = Simd::Load(this->z + i);
+
+        Simd::Store(this->x + i, Simd::Add(Simd::Add(Simd::Mul(m[0], vx), Simd::Mul(m[3], vy)), Simd::Add(Simd::Mul(m[6], vz), m[9])));
+        Simd::Store(this->y + i, Simd::Add(Simd::Add(Simd::Mul(m[1], vx), Simd::Mul(m[4], vy)), Simd::Add(Simd::Mul(m[7], vz), m[10])));
+        Simd::Store(this->z + i, Simd::Add(Simd::Add(Simd::Mul(m[2], vx), Simd::Mul(m[5], vy)), Simd::Add(Simd::Mul(m[8], vz), m[11])));
+    }
+}
+
+void PointBuffer::Transform(const DualQuaternion &placement)
+{   // Nine multiplies a point as a matrix, where the quaternion sandwich takes about twice that.
+    this->Transform(placement.Matrix());
+}
+
+void PointBuffer::Normalise()
+{
+    const Simd::Float4 zero = Simd::Splat(0.0f), one = Simd::Splat(1.0f);
+    const std::size_t padded = this->Padded();
+
+    for(std::size_t i = 0; i < padded; i += 4)
+    {
+        const Simd::Float4 vx = Simd::Load(this->x + i), vy = Simd::Load(this->y + i), vz = Simd::Load(this->z + i);
+        const Simd::Float4 length = Simd::Sqrt(Simd::Add(Simd::Add(Simd::Mul(vx, vx), Simd::Mul(vy, vy)), Simd::Mul(vz, vz)));
+        const Simd::Float4 scale = Simd::Select(Simd::NotEqual(length, zero), Simd::Div(one, length), one);
+
+        Simd::Store(this->x + i, Simd::Mul(vx, scale));
+        Simd::Store(this->y + i, Simd::Mul(vy, scale));
+        Simd::Store(this->z + i, Simd::Mul(vz, scale));
+    }
+}
+
+void PointBuffer::Dot(const PointBuffer &rhs, std::vector<float> &result) const
+{
+    const std::size_t padded = this->Padded();
+
+    // Room for the padding too, so the last block can be stored whole and then cut off.
+    result.resize(padded);
+
+    for(std::size_t i = 0; i < padded; i += 4)
+    {
+        const Simd::Float4 products = Simd::Add(Simd::Add(Simd::Mul(Simd::Load(this->x + i), Simd::Load(rhs.x + i)), Simd::Mul(Simd::Load(this->y + i), Simd::Load(rhs.y + i))), Simd::Mul(Simd::Load(this->z + i), Simd::Load(rhs.z + i)));
+
+        Simd::StoreUnaligned(&result[i], products);
+    }
+
+    result.resize(this->size);
+}
+
+void PointBuffer::Cross(const PointBuffer &rhs, PointBuffer &result) const
+{
+    const std::size_t padded = this->Padded();
+
+    if(&result != this && &result != &rhs)
+    {
+        result.Resize(this->size);
+    }
+
+    for(std::size_t i = 0; i < padded; i += 4)
+    {   // Everything is loaded before anything is stored, so result can be either side.
+        const Simd::Float4 ax = Simd::Load(this->x + i), ay = Simd::Load(this->y + i), az = Simd::Load(this->z + i);
+        const Simd::Float4 bx = Simd::Load(rhs.x + i), by = Simd::Load(rhs.y + i), bz = Simd::Load(rhs.z + i);
+
+        Simd::Store(result.x + i, Simd::Sub(Simd::Mul(ay, bz), Simd::Mul(az, by)));
+        Simd::Store(result.y + i, Simd::Sub(Simd::Mul(az, bx), Simd::Mul(ax, bz)));
+        Simd::Store(result.z + i, Simd::Sub(Simd::Mul(ax, by), Simd::Mul(ay, bx)));
+    }
+}
+
+const BoundingBox PointBuffer::Bounds() const
+{
+    BoundingBox bounds;
+    const std::size_t whole = this->size & ~static_cast<std::size_t>(3);
+
+    if(whole > 0)
+    {   // Whole blocks four lanes at a time, then the lanes are folded together.
+        Simd::Float4 lowX = Simd::Load(this->x), lowY = Simd::Load(this->y), lowZ = Simd::Load(this->z);
+        Simd::Float4 highX = lowX, highY = lowY, highZ = lowZ;
+
+        for(std::size_t i = 4; i < whole; i += 4)
+        {
+            const Simd::Float4 vx = Simd::Load(this->x + i), vy = Simd::Load(this->y + i), vz = Simd::Load(this->z + i);
+
+            lowX = Simd::Min(lowX, vx);
+            lowY = Simd::Min(lowY, vy);
+            lowZ = Simd::Min(lowZ, vz);
+            highX = Simd::Max(highX, vx);
+            highY = Simd::Max(highY, vy);
+            highZ = Simd::Max(highZ, vz);
+        }
+
+        for(int lane = 0; lane < 4; ++lane)
+        {
+            bounds.Add(Vector3(Simd::Get(lowX, lane), Simd::Get(lowY, lane), Simd::Get(lowZ, lane)));
+            bounds.Add(Vector3(Simd::Get(highX, lane), Simd::Get(highY, lane), Simd::Get(highZ, lane)));
+        }
+    }
+
+    // The last few points don't fill a block, and the padding mustn't count.
+    for(std::size_t i = whole; i < this->size; ++i)
+    {
+        bounds.Add(this->Get(i));
+    }
+
+    return bounds;
+}
+
+std::size_t PointBuffer::Padded() const
+{
+    return (this->size + 3) & ~static_cast<std::size_t>(3);
+}
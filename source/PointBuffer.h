@@ -0,0 +1,195 @@
+/*!
+**  \file PointBuffer.h
+**  \brief Defines the PointBuffer class
+**
+**  \author Andrew James
+**  \sa PointBuffer
+*/
+#ifndef __PointBuffer
+#define __PointBuffer
+
+#include "BoundingBox.h"
+#include "DualQuaternion.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+
+#include <vector>
+#include <cstddef>
+
+/*!
+**  \class PointBuffer
+**  \brief A lot of points stored as three float arrays, for moving them all at once.
+**
+**  An array of Vector3s puts x, y and z next to each other, so SSE has to shuffle every
+**   point into a register and back. Here all the xs are together, then all the ys, then
+**   all the zs, and each operation works on four points at a time with the same maths as
+**   Vector3 done a lane at a time. Nothing is shuffled, so the big operations go about as
+**   fast as memory can feed them.
+**  Each array starts on a 16 byte boundary and is padded to a multiple of four points.
+**   Whole blocks of four are always used, so the padding gets written with junk, but it's
+**   never handed back (Bounds() and Dot() leave it out).
+**  Falls back to plain floats when SSE isn't available, see Simd.
+*/
+class PointBuffer
+{
+public:
+    /*!
+    **  \brief Creates an empty buffer.
+    */
+    PointBuffer(void);
+
+    /*!
+    **  \brief Creates a buffer of points at the origin.
+    **
+    **  \param size The number of points.
+    */
+    explicit PointBuffer(const std::size_t &size);
+
+    /*!
+    **  \brief Copies the points.
+    **
+    **  \param rhs PointBuffer to copy.
+    */
+    PointBuffer(const PointBuffer &rhs);
+
+    /*!
+    **  \brief Frees the arrays.
+    */
+    ~PointBuffer();
+
+    /*!
+    **  \brief Copies the points.
+    **
+    **  \param rhs PointBuffer to copy.
+    **  \return A reference to self.
+    */
+    PointBuffer& operator=(const PointBuffer &rhs);
+
+    /*!
+    **  \brief Returns the number of points.
+    **
+    **  \return The number of points.
+    */
+    std::size_t Size() const;
+
+    /*!
+    **  \brief Sets the number of points, keeping the ones that are still in range.
+    **
+    **  New points are at the origin.
+    **  \param size The number of points.
+    */
+    void Resize(const std::size_t &size);
+
+    /*!
+    **  \brief Sets a point.
+    **
+    **  \param index Which point.
+    **  \param point The new value.
+    */
+    void Set(const std::size_t &index, const Vector3 &point);
+
+    /*!
+    **  \brief Returns a point.
+    **
+    **  \param index Which point.
+    **  \return The point.
+    */
+    const Vector3 Get(const std::size_t &index) const;
+
+    /*!
+    **  \brief Returns the x array, Size() long and 16 byte aligned.
+    **
+    **  \return The x of every point.
+    */
+    float* X();
+    const float* X() const;     //!< \sa X()
+
+    /*!
+    **  \brief Returns the y array, Size() long and 16 byte aligned.
+    **
+    **  \return The y of every point.
+    */
+    float* Y();
+    const float* Y() const;     //!< \sa Y()
+
+    /*!
+    **  \brief Returns the z array, Size() long and 16 byte aligned.
+    **
+    **  \return The z of every point.
+    */
+    float* Z();
+    const float* Z() const;     //!< \sa Z()
+
+    /*!
+    **  \brief Moves every point.
+    **
+    **  \param offset What to add to each point.
+    */
+    void Translate(const Vector3 &offset);
+
+    /*!
+    **  \brief Rotates every point about the origin, same as Quaternion::Rotate().
+    **
+    **  \param rotation A unit quaternion.
+    */
+    void Rotate(const Quaternion &rotation);
+
+    /*!
+    **  \brief Transforms every point by a matrix, same as Matrix4::TransformPoint().
+    **
+    **  \param matrix The transform.
+    */
+    void Transform(const Matrix4 &matrix);
+
+    /*!
+    **  \brief Transforms every point by a rotation and translation.
+    **
+    **  \param placement The transform.
+    */
+    void Transform(const DualQuaternion &placement);
+
+    /*!
+    **  \brief Scales every point to unit length, points at the origin are left alone.
+    */
+    void Normalise();
+
+    /*!
+    **  \brief Works out the dot product of each point with the matching point of another buffer.
+    **
+    **  \param rhs The other buffer, at least as big as this one.
+    **  \param result Set to one dot product per point.
+    */
+    void Dot(const PointBuffer &rhs, std::vector<float> &result) const;
+
+    /*!
+    **  \brief Works out the cross product of each point with the matching point of another buffer.
+    **
+    **  \param rhs The other buffer, at least as big as this one.
+    **  \param result Set to one cross product per point (can be this buffer or rhs).
+    */
+    void Cross(const PointBuffer &rhs, PointBuffer &result) const;
+
+    /*!
+    **  \brief Returns the bounding box of every point.
+    **
+    **  \return The bounds (empty if there are no points).
+    */
+    const BoundingBox Bounds() const;
+
+protected:
+    float *memory;          //!< The three arrays, with room to line them up on 16 bytes.
+    float *x;               //!< The x of every point.
+    float *y;               //!< The y of every point.
+    float *z;               //!< The z of every point.
+    std::size_t size;       //!< The number of points.
+    std::size_t stride;     //!< The number of points each array has room for, a multiple of four.
+
+    /*!
+    **  \brief Works out the number of whole blocks of four covering the points.
+    **
+    **  \return The number of floats in each array to run over.
+    */
+    std::size_t Padded() const;
+};
+#endif
@@ -1,5 +1,7 @@
 #include "Quaternion.h"
 
+#include "SimdQuaternion.h"
+
 #include <cmath>
 
 const float Quaternion::PI = 3.14159f;
@@ -65,7 +67,8 @@ Quaternion& Quaternion::operator/=(const float &scalar)
 
 const Quaternion Quaternion::operator*(const Quaternion &rhs) const
 {
-    return Quaternion(this->w * rhs.w - this->xyz.Dot(rhs.xyz), this->xyz * rhs.w + rhs.xyz * this->w + this->xyz.Cross(rhs.xyz)).Normalise();
+    // The constructor normalises, so there's no need to do it again.
+    return Quaternion(this->w * rhs.w - this->xyz.Dot(rhs.xyz), this->xyz * rhs.w + rhs.xyz * this->w + this->xyz.Cross(rhs.xyz));
 }
 
 
@@ -113,6 +116,23 @@ Quaternion& Quaternion::Normalise(void)
     return *this;
 }
 
+const Vector3 Quaternion::Rotate(const Vector3 &vector) const
+{
+    Vector3 twice = this->xyz.Cross(vector) * 2.0f;
+
+    return vector + twice * this->w + this->xyz.Cross(twice);
+}
+
+void Quaternion::Rotate(Vector3 *vectors, const std::size_t &count) const
+{
+    SimdQuaternion rotation(*this);
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        vectors[i] = (SimdVector3(vectors[i]) * rotation).Store();
+    }
+}
+
 float Quaternion::DegreesToRadians(float degrees)
 {
     return degrees * (Quaternion::PI / 180.0f);
@@ -132,5 +152,5 @@ Vector3& operator*=(Vector3 &lhs, const Quaternion &rhs)
 
 const Vector3 operator*(const Vector3 &lhs, const Quaternion &rhs)
 {
-    return Quaternion(rhs * (Quaternion(lhs) * rhs.Conjugate())).Axis();
+    return rhs.Rotate(lhs);
 }
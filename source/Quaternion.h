@@ -9,6 +9,8 @@
 
 #include "Vector3.h"
 
+#include <cstddef>
+
 /*!
 **  \class Quaternion
 **  \brief Defines a simple quaternion class with most needed functions.
@@ -158,6 +160,26 @@ public:
     */
     Quaternion& Normalise(void);
 
+    /*!
+    **  \brief Rotates a vector by the quaternion, keeping its length.
+    **
+    **  Works out q * v * q' as v + w * t + xyz x t, with t = 2 * (xyz x v). That's two cross
+    **   products, where going through Quaternion products is two full products (and three
+    **   normalisations).
+    **  \param vector The vector to rotate.
+    **  \return The rotated vector.
+    */
+    const Vector3 Rotate(const Vector3 &vector) const;
+
+    /*!
+    **  \brief Rotates an array of vectors by the quaternion, keeping their lengths.
+    **
+    **  The quaternion is only loaded once, and the vectors are rotated with SimdQuaternion.
+    **  \param vectors The vectors to rotate (rotated in place).
+    **  \param count The number of vectors.
+    */
+    void Rotate(Vector3 *vectors, const std::size_t &count) const;
+
     /*!
     **  \brief Converts degrees to radians.
     **
@@ -183,7 +205,7 @@ public:
 /*!
 **  \brief Rotates the lhs Vector3 around the specified Quaternion and saves the result in lhs.
 **
-**  lhs WILL BE NORMALISED. Save its magnitude beforehand in order to restore it to the same state.
+**  Same as Quaternion::Rotate(), the length of lhs is kept.
 **  \param lhs The Vector3 to be rotated.
 **  \param rhs The Quaternion to rotate around.
 **  \return A reference to lhs.
@@ -193,6 +215,7 @@ Vector3& operator*=(Vector3 &lhs, const Quaternion &rhs);
 /*!
 **  \brief Rotates a Vector3 around a Quaternion.
 **
+**  Same as Quaternion::Rotate(), the length of lhs is kept.
 **  \param lhs The Vector3 to be rotated
 **  \param rhs The Quaternion to rotate around.
 **  \return The rotated Vector3.
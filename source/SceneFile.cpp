@@ -0,0 +1,169 @@
+#include "SceneFile.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+const char SceneFile::MAGIC[4] = {'P', 'I', 'P', 'E'};
+const boost::uint32_t SceneFile::VERSION = 1;
+
+bool SceneFile::Save(const std::string &filename, const std::list<Pipe> &pipes)
+{
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if(!file)
+    {
+        return false;
+    }
+
+    Header header = MakeHeader(static_cast<boost::uint32_t>(pipes.size()));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<BoxRecord> boxes;
+
+    for(std::list<Pipe>::const_iterator it = pipes.begin(); it != pipes.end(); ++it)
+    {
+        boxes.clear();
+
+        for(Box::Handle handle = it->Head().Next(); handle != Box::NONE; handle = (*it)[handle].Next())
+        {
+            boxes.push_back(MakeBoxRecord((*it)[handle]));
+        }
+
+        PipeRecord pipe = MakePipeRecord(it->Head(), static_cast<boost::uint32_t>(boxes.size()));
+        file.write(reinterpret_cast<const char*>(&pipe), sizeof(pipe));
+
+        if(!boxes.empty())
+        {
+            file.write(reinterpret_cast<const char*>(&boxes[0]), boxes.size() * sizeof(BoxRecord));
+        }
+    }
+
+    return file.good();
+}
+
+bool SceneFile::Load(const std::string &filename, std::list<Pipe> &pipes)
+{
+    try
+    {
+        boost::interprocess::file_mapping file(filename.c_str(), boost::interprocess::read_only);
+        boost::interprocess::mapped_region region(file, boost::interprocess::read_only);
+
+        return Read(static_cast<const char*>(region.get_address()), region.get_size(), pipes);
+    }
+    catch(const boost::interprocess::interprocess_exception &)
+    {   // Couldn't open or map the file.
+        return false;
+    }
+}
+
+bool SceneFile::Read(const char *data, const std::size_t &size, std::list<Pipe> &pipes)
+{
+    const char *end = data + size;
+
+    if(size < sizeof(Header))
+    {
+        return false;
+    }
+
+    const Header *header = reinterpret_cast<const Header*>(data);
+    data += sizeof(Header);
+
+    if(std::memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0 || header->version != VERSION)
+    {
+        return false;
+    }
+
+    // Build everything off to the side, so a broken file doesn't leave half a scene behind.
+    std::list<Pipe> loaded;
+
+    for(boost::uint32_t i = 0; i < header->pipes; ++i)
+    {
+        if(static_cast<std::size_t>(end - data) < sizeof(PipeRecord))
+        {
+            return false;
+        }
+
+        const PipeRecord *pipe = reinterpret_cast<const PipeRecord*>(data);
+        data += sizeof(PipeRecord);
+
+        if(static_cast<std::size_t>(end - data) / sizeof(BoxRecord) < pipe->boxes)
+        {
+            return false;
+        }
+
+        // Fill the pipe in place, copying a pipe with millions of boxes into the list is not an option.
+        loaded.push_back(Pipe(Vector3()));
+        Pipe &restored = loaded.back();
+
+        restored.Head() = MasterBox(Vector3(pipe->position[0], pipe->position[1], pipe->position[2]),
+                                    Vector3(pipe->forward[0], pipe->forward[1], pipe->forward[2]),
+                                    Vector3(pipe->right[0], pipe->right[1], pipe->right[2]));
+        restored.Reserve(pipe->boxes);
+
+        const BoxRecord *box = reinterpret_cast<const BoxRecord*>(data);
+        data += pipe->boxes * sizeof(BoxRecord);
+
+        for(const BoxRecord *last = box + pipe->boxes; box != last; ++box)
+        {
+            if(!Valid(*box))
+            {
+                return false;
+            }
+
+            restored.Restore(Box(box->angle, Vector3(box->axis[0], box->axis[1], box->axis[2])));
+        }
+    }
+
+    pipes.splice(pipes.end(), loaded);
+
+    return true;
+}
+
+bool SceneFile::Valid(const BoxRecord &record)
+{   // Anything else would put the box somewhere off the grid (or on top of the last one).
+    return std::abs(record.axis[0]) + std::abs(record.axis[1]) + std::abs(record.axis[2]) == 1;
+}
+
+const SceneFile::Header SceneFile::MakeHeader(const boost::uint32_t &pipes)
+{
+    Header header;
+
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.pipes = pipes;
+    header.reserved = 0;
+
+    return header;
+}
+
+const SceneFile::PipeRecord SceneFile::MakePipeRecord(const MasterBox &head, const boost::uint32_t &boxes)
+{
+    Vector3 position = head.Position(), forward = head.Forward(), right = head.Right();
+
+    PipeRecord pipe = {{position.x, position.y, position.z},
+                       {forward.x, forward.y, forward.z},
+                       {right.x, right.y, right.z},
+                       boxes};
+
+    return pipe;
+}
+
+const SceneFile::BoxRecord SceneFile::MakeBoxRecord(const Box &box)
+{   // Axes are always one step along x, y or z, so they fit in a byte each.
+    BoxRecord record;
+    Vector3 axis = box.Axis();
+
+    record.angle = box.Angle();
+    record.axis[0] = static_cast<boost::int8_t>(floor(axis.x + 0.5f));
+    record.axis[1] = static_cast<boost::int8_t>(floor(axis.y + 0.5f));
+    record.axis[2] = static_cast<boost::int8_t>(floor(axis.z + 0.5f));
+    record.reserved = 0;
+
+    return record;
+}
@@ -0,0 +1,132 @@
+/*!
+**  \file SceneFile.h
+**  \brief Defines the SceneFile class
+**
+**  \author Andrew James
+**  \sa SceneFile
+*/
+#ifndef __SceneFile
+#define __SceneFile
+
+#include "Pipe.h"
+
+#include <list>
+#include <string>
+
+#include <boost/cstdint.hpp>
+
+/*!
+**  \class SceneFile
+**  \brief Saves and loads every pipe in a compact binary file.
+**
+**  The file is a Header, then for each pipe a PipeRecord followed by a BoxRecord for every
+**   box after the head, in pipe order. Everything is fixed size and in the byte order of the
+**   machine that saved it, so loading maps the file into memory and reads the records straight
+**   out of it, with no parsing and one allocation per pipe (see Pipe::Restore()). A file saved
+**   with the other byte order fails the version check instead of loading as garbage.
+*/
+class SceneFile
+{
+public:
+    const static char MAGIC[4];             //!< The first four bytes of every scene file.
+    const static boost::uint32_t VERSION;   //!< Version of the format written by Save().
+
+    /*!
+    **  \struct Header
+    **  \brief Start of the file.
+    */
+    struct Header
+    {
+        char magic[4];              //!< Always SceneFile::MAGIC.
+        boost::uint32_t version;    //!< Format version.
+        boost::uint32_t pipes;      //!< Number of pipes in the file.
+        boost::uint32_t reserved;   //!< Padding, always 0.
+    };
+
+    /*!
+    **  \struct PipeRecord
+    **  \brief The head of a pipe.
+    */
+    struct PipeRecord
+    {
+        float position[3];          //!< Position of the head.
+        float forward[3];           //!< Forward direction of the head.
+        float right[3];             //!< Right direction of the head (up is worked out from the other two).
+        boost::uint32_t boxes;      //!< Number of boxes after the head.
+    };
+
+    /*!
+    **  \struct BoxRecord
+    **  \brief A box following the head.
+    */
+    struct BoxRecord
+    {
+        float angle;                //!< Rotation angle in degrees.
+        boost::int8_t axis[3];      //!< Rotation axis (always one step along x, y or z).
+        boost::uint8_t reserved;    //!< Padding, always 0.
+    };
+
+    /*!
+    **  \brief Writes the pipes to a file.
+    **
+    **  \param filename The file to write.
+    **  \param pipes The pipes to save.
+    **  \return Returns true if the file was written.
+    */
+    static bool Save(const std::string &filename, const std::list<Pipe> &pipes);
+
+    /*!
+    **  \brief Reads the pipes from a file.
+    **
+    **  \param filename The file to read.
+    **  \param pipes List the loaded pipes are added to the end of.
+    **  \return Returns true if the file was read. If the return value is false, pipes
+    **           has not been modified.
+    */
+    static bool Load(const std::string &filename, std::list<Pipe> &pipes);
+
+    /*!
+    **  \brief Reads pipes from a scene file that's already in memory.
+    **
+    **  \param data Start of the file.
+    **  \param size Size of the file in bytes.
+    **  \param pipes List the loaded pipes are added to the end of.
+    **  \return Returns true if the data was a valid scene. If the return value is false,
+    **           pipes has not been modified.
+    */
+    static bool Read(const char *data, const std::size_t &size, std::list<Pipe> &pipes);
+
+    /*!
+    **  \brief Checks that a box read from a file has an axis Box can use.
+    **
+    **  \param record The box.
+    **  \return Returns true if the axis is one step along x, y or z.
+    */
+    static bool Valid(const BoxRecord &record);
+
+    /*!
+    **  \brief Fills in the header of a scene.
+    **
+    **  \param pipes The number of pipes in the scene.
+    **  \return The header.
+    */
+    static const Header MakeHeader(const boost::uint32_t &pipes);
+
+    /*!
+    **  \brief Fills in the record for the head of a pipe.
+    **
+    **  \param head The head of the pipe.
+    **  \param boxes The number of boxes after the head.
+    **  \return The record.
+    */
+    static const PipeRecord MakePipeRecord(const MasterBox &head, const boost::uint32_t &boxes);
+
+    /*!
+    **  \brief Fills in the record for a box.
+    **
+    **  \param box The box.
+    **  \return The record.
+    */
+    static const BoxRecord MakeBoxRecord(const Box &box);
+};
+#endif
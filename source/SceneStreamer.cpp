@@ -0,0 +1,346 @@
+#include "SceneStreamer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <boost/bind.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+SceneStreamer::Chunk::Chunk():loaded(false),pipes()
+{
+}
+
+SceneStreamer::SceneStreamer(PipeReclaimer &reclaimer, const int &radius):reclaimer(reclaimer),radius(radius),size(1.0f),index(),resident(),centre(),settled(false),file(),requests(),arrivals(),mutex(),pending(),running(false),worker()
+{
+}
+
+SceneStreamer::~SceneStreamer()
+{
+    this->Close();
+}
+
+bool SceneStreamer::Open(const std::string &filename)
+{
+    this->Close();
+
+    try
+    {
+        this->file.reset(new boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_only));
+
+        // Only the header and the table of chunks are read here, so mapping the whole file costs nothing.
+        boost::interprocess::mapped_region region(*this->file, boost::interprocess::read_only);
+        const char *data = static_cast<const char*>(region.get_address());
+        const std::size_t size = region.get_size();
+
+        if(size < sizeof(ChunkFile::Header))
+        {
+            this->file.reset();
+            return false;
+        }
+
+        const ChunkFile::Header *header = reinterpret_cast<const ChunkFile::Header*>(data);
+
+        if(std::memcmp(header->magic, ChunkFile::MAGIC, sizeof(header->magic)) != 0 || header->version != ChunkFile::VERSION ||
+           !(header->size > 0.0f) || (size - sizeof(ChunkFile::Header)) / sizeof(ChunkFile::ChunkRecord) < header->chunks)
+        {
+            this->file.reset();
+            return false;
+        }
+
+        const ChunkFile::ChunkRecord *record = reinterpret_cast<const ChunkFile::ChunkRecord*>(data + sizeof(ChunkFile::Header));
+
+        for(const ChunkFile::ChunkRecord *last = record + header->chunks; record != last; ++record)
+        {
+            if(record->offset > size || record->size > size - record->offset)
+            {   // Chunk runs off the end of the file.
+                this->index.clear();
+                this->file.reset();
+                return false;
+            }
+
+            this->index[record->key] = *record;
+        }
+
+        this->size = header->size;
+    }
+    catch(const boost::interprocess::interprocess_exception &)
+    {   // Couldn't open or map the file.
+        this->index.clear();
+        this->file.reset();
+        return false;
+    }
+
+    this->settled = false;
+    this->running = true;
+    this->worker.reset(new boost::thread(&SceneStreamer::Run, this));
+
+    return true;
+}
+
+void SceneStreamer::Close()
+{
+    if(this->worker)
+    {
+        {
+            boost::lock_guard<boost::mutex> lock(this->mutex);
+            this->running = false;
+        }
+
+        this->pending.notify_one();
+        this->worker->join();
+        this->worker.reset();
+    }
+
+    // The worker has stopped, so nothing else is touching the queues now.
+    this->requests.clear();
+
+    for(Arrivals::iterator it = this->arrivals.begin(); it != this->arrivals.end(); ++it)
+    {
+        this->reclaimer.Reclaim(it->second);
+    }
+
+    this->arrivals.clear();
+
+    for(Resident::iterator it = this->resident.begin(); it != this->resident.end(); ++it)
+    {
+        this->reclaimer.Reclaim(it->second.pipes);
+    }
+
+    this->resident.clear();
+    this->index.clear();
+    this->file.reset();
+}
+
+bool SceneStreamer::IsOpen() const
+{
+    return this->file.get() != 0;
+}
+
+void SceneStreamer::Update(const Vector3 &position)
+{
+    if(!this->file)
+    {
+        return;
+    }
+
+    const ChunkFile::Key key = ChunkFile::KeyOf(position, this->size);
+
+    if(!this->settled || !(key == this->centre))
+    {
+        this->centre = key;
+        this->settled = true;
+        this->Recentre();
+    }
+
+    Arrivals arrived;
+
+    {
+        boost::lock_guard<boost::mutex> lock(this->mutex);
+        arrived.swap(this->arrivals);
+    }
+
+    for(Arrivals::iterator it = arrived.begin(); it != arrived.end(); ++it)
+    {
+        Resident::iterator chunk = this->resident.find(it->first);
+
+        if(chunk != this->resident.end() && !chunk->second.loaded)
+        {
+            chunk->second.pipes.splice(chunk->second.pipes.end(), it->second);
+            chunk->second.loaded = true;
+        }
+        else
+        {   // The camera moved away before the chunk finished loading.
+            this->reclaimer.Reclaim(it->second);
+        }
+    }
+}
+
+void SceneStreamer::Prepare(JobPool &jobs) const
+{
+    for(Resident::const_iterator chunk = this->resident.begin(); chunk != this->resident.end(); ++chunk)
+    {
+        for(std::list<Pipe>::const_iterator it = chunk->second.pipes.begin(); it != chunk->second.pipes.end(); ++it)
+        {
+            if(!it->Current())
+            {   // Only pipes that have just arrived, streamed pipes are never edited.
+                jobs.Add(boost::bind(&Pipe::Prepare, &*it, boost::ref(jobs)));
+            }
+        }
+    }
+}
+
+void SceneStreamer::Draw(const Frustum &frustum, const Detail &detail) const
+{
+    for(Resident::const_iterator chunk = this->resident.begin(); chunk != this->resident.end(); ++chunk)
+    {
+        if(chunk->second.pipes.empty() || frustum.Test(Bounds(chunk->first)) == Frustum::OUTSIDE)
+        {   // One test for the whole chunk, rather than one for every pipe in it.
+            continue;
+        }
+
+        for(std::list<Pipe>::const_iterator it = chunk->second.pipes.begin(); it != chunk->second.pipes.end(); ++it)
+        {
+            it->Draw(frustum, detail);
+        }
+    }
+}
+
+void SceneStreamer::Run()
+{
+    while(true)
+    {
+        ChunkFile::ChunkRecord record;
+
+        {
+            boost::unique_lock<boost::mutex> lock(this->mutex);
+
+            while(this->running && this->requests.empty())
+            {
+                this->pending.wait(lock);
+            }
+
+            if(!this->running)
+            {
+                return;
+            }
+
+            record = this->requests.front();
+            this->requests.pop_front();
+        }
+
+        // Read the chunk outside the lock, so the frame thread never waits on the disk.
+        std::list<Pipe> pipes;
+
+        try
+        {
+            boost::interprocess::mapped_region region(*this->file, boost::interprocess::read_only,
+                                                      static_cast<boost::interprocess::offset_t>(record.offset),
+                                                      static_cast<std::size_t>(record.size));
+
+            if(!SceneFile::Read(static_cast<const char*>(region.get_address()), region.get_size(), pipes))
+            {   // A broken chunk is left empty rather than asked for again and again.
+                pipes.clear();
+            }
+        }
+        catch(const boost::interprocess::interprocess_exception &)
+        {   // Same goes for one that can't be mapped.
+            pipes.clear();
+        }
+
+        for(std::list<Pipe>::const_iterator it = pipes.begin(); it != pipes.end(); ++it)
+        {   // Placed here rather than a slice a frame, the frame thread has enough to do.
+            it->Settle();
+        }
+
+        {
+            boost::lock_guard<boost::mutex> lock(this->mutex);
+            this->arrivals.push_back(std::make_pair(record.key, std::list<Pipe>()));
+            this->arrivals.back().second.swap(pipes);
+        }
+    }
+}
+
+void SceneStreamer::Recentre()
+{
+    // Drop chunks that have drifted out of range. They get one chunk of slack, so a camera
+    // wobbling back and forth over a chunk boundary doesn't keep loading the same chunks.
+    for(Resident::iterator it = this->resident.begin(); it != this->resident.end();)
+    {
+        if(Distance(it->first, this->centre) > this->radius + 1)
+        {
+            this->reclaimer.Reclaim(it->second.pipes);
+            this->resident.erase(it++);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    {
+        boost::lock_guard<boost::mutex> lock(this->mutex);
+
+        // Rebuild the queue closest first, keeping anything still waiting that's in range.
+        std::set<ChunkFile::Key> queued;
+
+        for(std::deque<ChunkFile::ChunkRecord>::const_iterator it = this->requests.begin(); it != this->requests.end(); ++it)
+        {
+            queued.insert(it->key);
+        }
+
+        this->requests.clear();
+
+        for(int ring = 0; ring <= this->radius; ++ring)
+        {
+            for(int x = -ring; x <= ring; ++x)
+            {
+                for(int y = -ring; y <= ring; ++y)
+                {
+                    for(int z = -ring; z <= ring; ++z)
+                    {
+                        if(std::max(std::abs(x), std::max(std::abs(y), std::abs(z))) != ring)
+                        {   // Inside the ring, already been through it.
+                            continue;
+                        }
+
+                        ChunkFile::Key key = this->centre;
+                        key.x += x;
+                        key.y += y;
+                        key.z += z;
+
+                        Index::const_iterator record = this->index.find(key);
+
+                        if(record == this->index.end())
+                        {   // Nothing in this chunk.
+                            continue;
+                        }
+
+                        Resident::iterator chunk = this->resident.find(key);
+
+                        if(chunk == this->resident.end())
+                        {
+                            this->resident[key] = Chunk();
+                            this->requests.push_back(record->second);
+                        }
+                        else if(queued.count(key))
+                        {
+                            this->requests.push_back(record->second);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Chunks in the slack that were still waiting have just been dropped from the queue,
+        // so forget them or they'd never be asked for again. Ones being read are kept.
+        for(Resident::iterator it = this->resident.begin(); it != this->resident.end();)
+        {
+            if(!it->second.loaded && queued.count(it->first) && Distance(it->first, this->centre) > this->radius)
+            {
+                this->resident.erase(it++);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    this->pending.notify_one();
+}
+
+const BoundingBox SceneStreamer::Bounds(const ChunkFile::Key &key) const
+{   // Boxes are put in the chunk their centre is in, and a corner is never more than a unit from the centre.
+    BoundingBox bounds;
+
+    bounds.Add(Vector3(key.x * this->size - 1.0f, key.y * this->size - 1.0f, key.z * this->size - 1.0f));
+    bounds.Add(Vector3((key.x + 1) * this->size + 1.0f, (key.y + 1) * this->size + 1.0f, (key.z + 1) * this->size + 1.0f));
+
+    return bounds;
+}
+
+int SceneStreamer::Distance(const ChunkFile::Key &lhs, const ChunkFile::Key &rhs)
+{
+    return std::max(std::abs(lhs.x - rhs.x), std::max(std::abs(lhs.y - rhs.y), std::abs(lhs.z - rhs.z)));
+}
@@ -0,0 +1,176 @@
+/*!
+**  \file SceneStreamer.h
+**  \brief Defines the SceneStreamer class
+**
+**  \author Andrew James
+**  \sa SceneStreamer
+*/
+#ifndef __SceneStreamer
+#define __SceneStreamer
+
+#include "ChunkFile.h"
+#include "PipeReclaimer.h"
+
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+
+/*!
+**  \class SceneStreamer
+**  \brief Keeps the chunks of a ChunkFile around the camera loaded.
+**
+**  Scenes too big to fit in memory are saved as a ChunkFile, and only the chunks within
+**   a few chunks of the camera are kept in memory. Chunks are read on a worker thread,
+**   the frame thread just hands it a list of chunks to read and picks up whatever has
+**   finished, so it never waits on the disk. Chunks that drift out of range are handed
+**   to the PipeReclaimer.
+**  Streamed pipes are scenery, they're drawn but aren't part of gPipes, so they can't be
+**   selected or edited.
+*/
+class SceneStreamer
+{
+public:
+    /*!
+    **  \brief Creates a streamer with nothing open.
+    **
+    **  \param reclaimer Where to send chunks that are no longer needed.
+    **  \param radius Chunks this many chunks or less from the camera (in each direction) are loaded.
+    */
+    SceneStreamer(PipeReclaimer &reclaimer, const int &radius);
+
+    /*!
+    **  \brief Closes the file.
+    */
+    ~SceneStreamer();
+
+    /*!
+    **  \brief Starts streaming a chunk file, closing whatever was open before.
+    **
+    **  Only the table of chunks is read here, the chunks themselves are loaded as the
+    **   camera gets near them.
+    **  \param filename The file to stream.
+    **  \return Returns true if the file was opened.
+    */
+    bool Open(const std::string &filename);
+
+    /*!
+    **  \brief Stops streaming and drops every loaded chunk.
+    */
+    void Close();
+
+    /*!
+    **  \brief Checks if a file is being streamed.
+    **
+    **  \return Returns true if a file is open.
+    */
+    bool IsOpen() const;
+
+    /*!
+    **  \brief Asks for the chunks around a position and picks up any that have been loaded.
+    **
+    **  Call once a frame with the camera position.
+    **  \param position Where the camera is.
+    */
+    void Update(const Vector3 &position);
+
+    /*!
+    **  \brief Queues the work of bringing the meshes of loaded chunks up to date (see Pipe::Prepare()).
+    **
+    **  Call before Draw(), and wait for the jobs to finish in between.
+    **  \param jobs Where to queue the work.
+    */
+    void Prepare(JobPool &jobs) const;
+
+    /*!
+    **  \brief Draws every loaded chunk in view.
+    **
+    **  Expects the vertex, normal and colour arrays to be enabled.
+    **  \param frustum What the camera can see.
+    **  \param detail When to switch far away chunks to low detail.
+    */
+    void Draw(const Frustum &frustum, const Detail &detail) const;
+
+protected:
+    /*!
+    **  \struct Chunk
+    **  \brief A chunk that's loaded, or waiting to be.
+    */
+    struct Chunk
+    {
+        /*!
+        **  \brief Creates a chunk that hasn't been loaded yet.
+        */
+        Chunk(void);
+
+        bool loaded;                //!< Has the chunk arrived from the worker thread?
+        std::list<Pipe> pipes;      //!< The pipes in the chunk.
+    };
+
+    typedef std::map<ChunkFile::Key, ChunkFile::ChunkRecord> Index;                 //!< Every chunk in the file.
+    typedef std::map<ChunkFile::Key, Chunk> Resident;                               //!< Chunks loaded or waiting to be.
+    typedef std::list<std::pair<ChunkFile::Key, std::list<Pipe> > > Arrivals;       //!< Chunks the worker thread has finished with.
+
+    PipeReclaimer &reclaimer;       //!< Where unloaded chunks go.
+    int radius;                     //!< How many chunks either side of the camera to keep loaded.
+
+    float size;                     //!< Length of the side of a chunk.
+    Index index;                    //!< Every chunk in the file.
+    Resident resident;              //!< Chunks that are loaded or on their way.
+    ChunkFile::Key centre;          //!< Chunk the camera was in at the last update.
+    bool settled;                   //!< Has anything been requested since the file was opened?
+
+    boost::scoped_ptr<boost::interprocess::file_mapping> file;  //!< The open file (shared with the worker thread).
+
+    std::deque<ChunkFile::ChunkRecord> requests;    //!< Chunks waiting to be read.
+    Arrivals arrivals;                              //!< Chunks that have been read.
+    boost::mutex mutex;                             //!< Guards the requests, the arrivals and the running flag.
+    boost::condition_variable pending;              //!< Signalled when something is requested (or we're shutting down).
+    bool running;                                   //!< Set to false to stop the worker thread.
+    boost::scoped_ptr<boost::thread> worker;        //!< Reads chunks while a file is open.
+
+    /*!
+    **  \brief Worker thread loop, reads requested chunks until told to stop.
+    */
+    void Run();
+
+    /*!
+    **  \brief Requests the chunks around the centre and drops the ones too far from it.
+    */
+    void Recentre();
+
+    /*!
+    **  \brief Works out how many chunks apart two chunks are, counting diagonal steps as one.
+    **
+    **  \param lhs One chunk.
+    **  \param rhs The other chunk.
+    **  \return The largest difference along any axis.
+    */
+    static int Distance(const ChunkFile::Key &lhs, const ChunkFile::Key &rhs);
+
+    /*!
+    **  \brief Works out the space a chunk's boxes can take up.
+    **
+    **  \param key The chunk.
+    **  \return The cube of the chunk, grown by enough to fit boxes centred on its edges.
+    */
+    const BoundingBox Bounds(const ChunkFile::Key &key) const;
+
+private:
+    /*!
+    **  \brief Copy constructor is not allowed, the worker thread belongs to one streamer.
+    */
+    SceneStreamer(const SceneStreamer &rhs);
+
+    /*!
+    **  \brief Assignment operator is not allowed, the worker thread belongs to one streamer.
+    */
+    SceneStreamer& operator=(const SceneStreamer &rhs);
+};
+#endif
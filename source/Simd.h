@@ -0,0 +1,343 @@
+/*!
+**  \file Simd.h
+**  \brief Defines the Simd class
+**
+**  \author Andrew James
+**  \sa Simd
+*/
+#ifndef __Simd
+#define __Simd
+
+// SSE is there on anything x64, and on x86 when the compiler is told it can use it
+//  (/arch:SSE or /arch:SSE2, which the project sets for both configurations). Without
+//  it this quietly falls back to plain floats. Define NO_SIMD to build that version anyway.
+#if !defined(NO_SIMD) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__))
+#define __SIMD_SSE
+#include <xmmintrin.h>
+#endif
+
+#include <cmath>
+#include <algorithm>
+
+/*!
+**  \class Simd
+**  \brief Four floats at once, in an SSE register when there is one.
+**
+**  SimdVector3 and SimdQuaternion are written in terms of these, so there's one copy of
+**   the maths whether or not the compiler can use SSE. Everything is inline so it all
+**   ends up in the caller.
+**  A Float4 holding SSE needs 16 byte alignment. The stack gets that for free, but the
+**   heap (and so anything inside a std::vector or std::list) doesn't before MSVC 2010.
+**   So keep them in locals, pass them by reference and store Vector3s in anything
+**   long lived.
+*/
+class Simd
+{
+public:
+#ifdef __SIMD_SSE
+    typedef __m128 Float4;      //!< Four floats in an SSE register.
+#else
+    /*!
+    **  \struct Float4
+    **  \brief Four plain floats.
+    */
+    struct Float4
+    {
+        float v[4];             //!< The elements.
+    };
+#endif
+
+    /*!
+    **  \brief Creates a Float4 from its elements.
+    **
+    **  \return (x, y, z, w).
+    */
+    static Float4 Set(const float &x, const float &y, const float &z, const float &w)
+    {
+#ifdef __SIMD_SSE
+        return _mm_setr_ps(x, y, z, w);
+#else
+        Float4 result = {{ x, y, z, w }};
+        return result;
+#endif
+    }
+
+    /*!
+    **  \brief Creates a Float4 with every element the same.
+    **
+    **  \return (s, s, s, s).
+    */
+    static Float4 Splat(const float &s)
+    {
+#ifdef __SIMD_SSE
+        return _mm_set1_ps(s);
+#else
+        return Set(s, s, s, s);
+#endif
+    }
+
+    /*!
+    **  \brief Adds each element.
+    */
+    static Float4 Add(const Float4 &a, const Float4 &b)
+    {
+#ifdef __SIMD_SSE
+        return _mm_add_ps(a, b);
+#else
+        return Set(a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]);
+#endif
+    }
+
+    /*!
+    **  \brief Subtracts each element.
+    */
+    static Float4 Sub(const Float4 &a, const Float4 &b)
+    {
+#ifdef __SIMD_SSE
+        return _mm_sub_ps(a, b);
+#else
+        return Set(a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]);
+#endif
+    }
+
+    /*!
+    **  \brief Multiplies each element.
+    */
+    static Float4 Mul(const Float4 &a, const Float4 &b)
+    {
+#ifdef __SIMD_SSE
+        return _mm_mul_ps(a, b);
+#else
+        return Set(a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]);
+#endif
+    }
+
+    /*!
+    **  \brief Divides each element.
+    */
+    static Float4 Div(const Float4 &a, const Float4 &b)
+    {
+#ifdef __SIMD_SSE
+        return _mm_div_ps(a, b);
+#else
+        return Set(a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]);
+#endif
+    }
+
+    /*!
+    **  \brief Square root of each element.
+    */
+    static Float4 Sqrt(const Float4 &a)
+    {
+#ifdef __SIMD_SSE
+        return _mm_sqrt_ps(a);
+#else
+        return Set(sqrt(a.v[0]), sqrt(a.v[1]), sqrt(a.v[2]), sqrt(a.v[3]));
+#endif
+    }
+
+    /*!
+    **  \brief Rotates x, y and z left, for cross products.
+    **
+    **  \return (y, z, x, w).
+    */
+    static Float4 YZX(const Float4 &a)
+    {
+#ifdef __SIMD_SSE
+        return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+#else
+        return Set(a.v[1], a.v[2], a.v[0], a.v[3]);
+#endif
+    }
+
+    /*!
+    **  \brief Rotates x, y and z right, for cross products.
+    **
+    **  \return (z, x, y, w).
+    */
+    static Float4 ZXY(const Float4 &a)
+    {
+#ifdef __SIMD_SSE
+        return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+#else
+        return Set(a.v[2], a.v[0], a.v[1], a.v[3]);
+#endif
+    }
+
+    /*!
+    **  \brief Copies w into every element.
+    **
+    **  \return (w, w, w, w).
+    */
+    static Float4 W(const Float4 &a)
+    {
+#ifdef __SIMD_SSE
+        return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3));
+#else
+        return Splat(a.v[3]);
+#endif
+    }
+
+    /*!
+    **  \brief Dot product of x, y and z, in every element.
+    */
+    static Float4 Dot3(const Float4 &a, const Float4 &b)
+    {
+#ifdef __SIMD_SSE
+        __m128 product = _mm_mul_ps(a, b);
+        __m128 sum = _mm_add_ss(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1)));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 2, 2, 2)));
+        return _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 0));
+#else
+        return Splat(a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2]);
+#endif
+    }
+
+    /*!
+    **  \brief Dot product of all four elements, in every element.
+    */
+    static Float4 Dot4(const Float4 &a, const Float4 &b)
+    {
+#ifdef __SIMD_SSE
+        __m128 product = _mm_mul_ps(a, b);
+        __m128 sum = _mm_add_ps(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+#else
+        return Splat(a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] + a.v[3] * b.v[3]);
+#endif
+    }
+
+    /*!
+    **  \brief Loads four floats from 16 byte aligned memory.
+    */
+    static Float4 Load(const float *memory)
+    {
+#ifdef __SIMD_SSE
+        return _mm_load_ps(memory);
+#else
+        return Set(memory[0], memory[1], memory[2], memory[3]);
+#endif
+    }
+
+    /*!
+    **  \brief Loads four floats from memory with any alignment.
+    */
+    static Float4 LoadUnaligned(const float *memory)
+    {
+#ifdef __SIMD_SSE
+        return _mm_loadu_ps(memory);
+#else
+        return Load(memory);
+#endif
+    }
+
+    /*!
+    **  \brief Stores four floats to 16 byte aligned memory.
+    */
+    static void Store(float *memory, const Float4 &a)
+    {
+#ifdef __SIMD_SSE
+        _mm_store_ps(memory, a);
+#else
+        StoreUnaligned(memory, a);
+#endif
+    }
+
+    /*!
+    **  \brief Stores four floats to memory with any alignment.
+    */
+    static void StoreUnaligned(float *memory, const Float4 &a)
+    {
+#ifdef __SIMD_SSE
+        _mm_storeu_ps(memory, a);
+#else
+        for(int i = 0; i < 4; ++i)
+        {
+            memory[i] = a.v[i];
+        }
+#endif
+    }
+
+    /*!
+    **  \brief Smaller of each element.
+    */
+    static Float4 Min(const Float4 &a, const Float4 &b)
+    {
+#ifdef __SIMD_SSE
+        return _mm_min_ps(a, b);
+#else
+        return Set(std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3]));
+#endif
+    }
+
+    /*!
+    **  \brief Larger of each element.
+    */
+    static Float4 Max(const Float4 &a, const Float4 &b)
+    {
+#ifdef __SIMD_SSE
+        return _mm_max_ps(a, b);
+#else
+        return Set(std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]), std::max(a.v[2], b.v[2]), std::max(a.v[3], b.v[3]));
+#endif
+    }
+
+    /*!
+    **  \brief Compares each element, for Select().
+    **
+    **  \return A mask with the elements that aren't equal set.
+    */
+    static Float4 NotEqual(const Float4 &a, const Float4 &b)
+    {
+#ifdef __SIMD_SSE
+        return _mm_cmpneq_ps(a, b);
+#else
+        return Set(a.v[0] != b.v[0], a.v[1] != b.v[1], a.v[2] != b.v[2], a.v[3] != b.v[3]);
+#endif
+    }
+
+    /*!
+    **  \brief Picks each element from a where the mask is set, otherwise from b.
+    **
+    **  \param mask A mask from one of the comparisons.
+    */
+    static Float4 Select(const Float4 &mask, const Float4 &a, const Float4 &b)
+    {
+#ifdef __SIMD_SSE
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+#else
+        return Set(mask.v[0] ? a.v[0] : b.v[0], mask.v[1] ? a.v[1] : b.v[1], mask.v[2] ? a.v[2] : b.v[2], mask.v[3] ? a.v[3] : b.v[3]);
+#endif
+    }
+
+    /*!
+    **  \brief Returns one element.
+    **
+    **  \param a The Float4.
+    **  \param i Which element (0 to 3).
+    **  \return The element.
+    */
+    static float Get(const Float4 &a, const int &i)
+    {
+#ifdef __SIMD_SSE
+        float v[4];
+        _mm_storeu_ps(v, a);
+        return v[i];
+#else
+        return a.v[i];
+#endif
+    }
+
+    /*!
+    **  \brief Returns the first element.
+    */
+    static float X(const Float4 &a)
+    {
+#ifdef __SIMD_SSE
+        return _mm_cvtss_f32(a);
+#else
+        return a.v[0];
+#endif
+    }
+};
+#endif
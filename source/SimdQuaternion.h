@@ -0,0 +1,171 @@
+/*!
+**  \file SimdQuaternion.h
+**  \brief Defines the SimdQuaternion class
+**
+**  \author Andrew James
+**  \sa SimdQuaternion
+*/
+#ifndef __SimdQuaternion
+#define __SimdQuaternion
+
+#include "Simd.h"
+#include "SimdVector3.h"
+#include "Quaternion.h"
+
+/*!
+**  \class SimdQuaternion
+**  \brief A Quaternion that lives in one SSE register, for doing a lot of maths at once.
+**
+**  Same operations as Quaternion, but all inline, and a product is normalised once
+**   instead of building a Quaternion (which normalises) and then normalising it again.
+**  Stored as (x, y, z, w).
+*/
+class SimdQuaternion
+{
+public:
+    /*!
+    **  \brief No args constructor creates a SimdQuaternion with no rotation.
+    */
+    SimdQuaternion(void):v(Simd::Set(0.0f, 0.0f, 0.0f, 1.0f))
+    {
+    }
+
+    /*!
+    **  \brief Creates a SimdQuaternion with the specified angle around the given axis.
+    **
+    **  Normalised afterwards, same as Quaternion.
+    **  \param axis The rotation axis.
+    **  \param angle The angle of rotation in radians.
+    */
+    SimdQuaternion(const SimdVector3 &axis, const float &angle):v(Simd::Add(Simd::Mul(axis.v, Simd::Splat(sin(angle / 2.0f))), Simd::Set(0.0f, 0.0f, 0.0f, cos(angle / 2.0f))))
+    {
+        Normalise();
+    }
+
+    /*!
+    **  \brief Loads a Quaternion.
+    **
+    **  \param rhs The Quaternion to load.
+    */
+    explicit SimdQuaternion(const Quaternion &rhs):v(Simd::Set(rhs.xyz.x, rhs.xyz.y, rhs.xyz.z, rhs.w))
+    {
+    }
+
+    /*!
+    **  \brief Wraps a Float4.
+    **
+    **  \param _v The elements (x, y, z, w).
+    */
+    explicit SimdQuaternion(const Simd::Float4 &_v):v(_v)
+    {
+    }
+
+    /*!
+    **  \brief Returns the rotation as a Quaternion.
+    **
+    **  \return The Quaternion.
+    */
+    const Quaternion Store() const
+    {
+        return Quaternion(Simd::Get(this->v, 3), Vector3(Simd::Get(this->v, 0), Simd::Get(this->v, 1), Simd::Get(this->v, 2)));
+    }
+
+    /*!
+    **  \brief Multiplies self by the given SimdQuaternion and returns the result.
+    **
+    **  \param rhs The rhs of the multiplication.
+    **  \return The normalised product.
+    */
+    const SimdQuaternion operator*(const SimdQuaternion &rhs) const
+    {   // xyz is w1 * v2 + w2 * v1 + v1 x v2, which leaves 2 * w1 * w2 in w where it should be w1 * w2 - v1.v2.
+        Simd::Float4 w1 = Simd::W(this->v);
+        Simd::Float4 w2 = Simd::W(rhs.v);
+        Simd::Float4 sum = Simd::Add(Simd::Mul(w1, rhs.v), Simd::Mul(this->v, w2));
+        Simd::Float4 cross = Simd::Sub(Simd::Mul(Simd::YZX(this->v), Simd::ZXY(rhs.v)), Simd::Mul(Simd::ZXY(this->v), Simd::YZX(rhs.v)));
+        Simd::Float4 fix = Simd::Mul(Simd::Set(0.0f, 0.0f, 0.0f, 1.0f), Simd::Add(Simd::Mul(w1, w2), Simd::Dot3(this->v, rhs.v)));
+
+        return SimdQuaternion(Simd::Sub(Simd::Add(sum, cross), fix)).Normalise();
+    }
+
+    /*!
+    **  \brief Multiplies self by the given SimdQuaternion then assigns the result to self.
+    **
+    **  \param rhs The rhs of the multiplication.
+    **  \return A reference to self.
+    */
+    SimdQuaternion& operator*=(const SimdQuaternion &rhs)
+    {
+        *this = *this * rhs;
+        return *this;
+    }
+
+    /*!
+    **  \brief Returns the conjugate of the quaternion.
+    **
+    **  \return The conjugate (-x, -y, -z, w).
+    */
+    const SimdQuaternion Conjugate(void) const
+    {
+        return SimdQuaternion(Simd::Mul(this->v, Simd::Set(-1.0f, -1.0f, -1.0f, 1.0f)));
+    }
+
+    /*!
+    **  \brief Returns the magnitude (or length) of the quaternion.
+    **
+    **  \return The magnitude.
+    */
+    const float Magnitude(void) const
+    {
+        return Simd::X(Simd::Sqrt(Simd::Dot4(this->v, this->v)));
+    }
+
+    /*!
+    **  \brief Normalises the quaternion (leaves a null quaternion alone).
+    **
+    **  \return A reference to self.
+    */
+    SimdQuaternion& Normalise(void)
+    {
+        Simd::Float4 length = Simd::Sqrt(Simd::Dot4(this->v, this->v));
+
+        if(Simd::X(length) != 0.0f)
+        {
+            this->v = Simd::Div(this->v, length);
+        }
+
+        return *this;
+    }
+
+    Simd::Float4 v;     //!< The elements (x, y, z, w).
+};
+
+/*!
+**  \brief Rotates a SimdVector3 around a SimdQuaternion.
+**
+**  Same as Quaternion::Rotate(), the length of lhs is kept.
+**  \param lhs The vector to be rotated.
+**  \param rhs The quaternion to rotate around.
+**  \return The rotated vector.
+*/
+inline const SimdVector3 operator*(const SimdVector3 &lhs, const SimdQuaternion &rhs)
+{
+    SimdVector3 axis(Simd::Mul(rhs.v, Simd::Set(1.0f, 1.0f, 1.0f, 0.0f)));
+    SimdVector3 twice = axis.Cross(lhs) * 2.0f;
+
+    return lhs + SimdVector3(Simd::Mul(twice.v, Simd::W(rhs.v))) + axis.Cross(twice);
+}
+
+/*!
+**  \brief Rotates the lhs SimdVector3 around the specified SimdQuaternion and saves the result in lhs.
+**
+**  Same as Quaternion::Rotate(), the length of lhs is kept.
+**  \param lhs The vector to be rotated.
+**  \param rhs The quaternion to rotate around.
+**  \return A reference to lhs.
+*/
+inline SimdVector3& operator*=(SimdVector3 &lhs, const SimdQuaternion &rhs)
+{
+    lhs = lhs * rhs;
+    return lhs;
+}
+#endif
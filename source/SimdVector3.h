@@ -0,0 +1,225 @@
+/*!
+**  \file SimdVector3.h
+**  \brief Defines the SimdVector3 class
+**
+**  \author Andrew James
+**  \sa SimdVector3
+*/
+#ifndef __SimdVector3
+#define __SimdVector3
+
+#include "Simd.h"
+#include "Vector3.h"
+
+/*!
+**  \class SimdVector3
+**  \brief A Vector3 that lives in one SSE register, for doing a lot of maths at once.
+**
+**  Same operations as Vector3, but all inline, so a string of them compiles down to a
+**   handful of instructions instead of a call each. Load a Vector3 in, do the work and
+**   Store() the answer back out (see Simd about keeping these off the heap).
+**  The fourth element is always 0.
+*/
+class SimdVector3
+{
+public:
+    /*!
+    **  \brief No args constructor creates a vector with all elements set to 0.
+    */
+    SimdVector3(void):v(Simd::Splat(0.0f))
+    {
+    }
+
+    /*!
+    **  \brief Creates a SimdVector3 with the specified values for each element.
+    **
+    **  \param _x The initial x value.
+    **  \param _y The initial y value.
+    **  \param _z The initial z value.
+    */
+    SimdVector3(const float &_x, const float &_y, const float &_z):v(Simd::Set(_x, _y, _z, 0.0f))
+    {
+    }
+
+    /*!
+    **  \brief Loads a Vector3.
+    **
+    **  \param rhs The Vector3 to load.
+    */
+    explicit SimdVector3(const Vector3 &rhs):v(Simd::Set(rhs.x, rhs.y, rhs.z, 0.0f))
+    {
+    }
+
+    /*!
+    **  \brief Wraps a Float4 (the w must be 0).
+    **
+    **  \param _v The elements.
+    */
+    explicit SimdVector3(const Simd::Float4 &_v):v(_v)
+    {
+    }
+
+    /*!
+    **  \brief Returns the vector as a Vector3.
+    **
+    **  \return The Vector3.
+    */
+    const Vector3 Store() const
+    {
+        return Vector3(Simd::Get(this->v, 0), Simd::Get(this->v, 1), Simd::Get(this->v, 2));
+    }
+
+    /*!
+    **  \brief Returns a SimdVector3 with elements set to the negated values of this one.
+    **
+    **  \return The negated vector (-x, -y, -z).
+    */
+    const SimdVector3 operator-(void) const
+    {
+        return SimdVector3(Simd::Sub(Simd::Splat(0.0f), this->v));
+    }
+
+    /*!
+    **  \brief Adds the given vector to self.
+    **
+    **  \param rhs The rhs of the addition.
+    **  \return A reference to self.
+    */
+    SimdVector3& operator+=(const SimdVector3 &rhs)
+    {
+        this->v = Simd::Add(this->v, rhs.v);
+        return *this;
+    }
+
+    /*!
+    **  \brief Subtracts the given vector from self.
+    **
+    **  \param rhs The rhs of the subtraction.
+    **  \return A reference to self.
+    */
+    SimdVector3& operator-=(const SimdVector3 &rhs)
+    {
+        this->v = Simd::Sub(this->v, rhs.v);
+        return *this;
+    }
+
+    /*!
+    **  \brief Multiplies self by the given scalar.
+    **
+    **  \param scalar The rhs of the multiplication.
+    **  \return A reference to self.
+    */
+    SimdVector3& operator*=(const float &scalar)
+    {
+        this->v = Simd::Mul(this->v, Simd::Splat(scalar));
+        return *this;
+    }
+
+    /*!
+    **  \brief Divides self by the given scalar.
+    **
+    **  \param scalar The rhs of the division.
+    **  \return A reference to self.
+    */
+    SimdVector3& operator/=(const float &scalar)
+    {   // Only divide x, y and z, so w stays 0.
+        this->v = Simd::Div(this->v, Simd::Set(scalar, scalar, scalar, 1.0f));
+        return *this;
+    }
+
+    /*!
+    **  \brief Adds two vectors.
+    **
+    **  \param rhs The rhs of the addition.
+    **  \return The sum.
+    */
+    const SimdVector3 operator+(const SimdVector3 &rhs) const
+    {
+        return SimdVector3(Simd::Add(this->v, rhs.v));
+    }
+
+    /*!
+    **  \brief Subtracts two vectors.
+    **
+    **  \param rhs The rhs of the subtraction.
+    **  \return The difference.
+    */
+    const SimdVector3 operator-(const SimdVector3 &rhs) const
+    {
+        return SimdVector3(Simd::Sub(this->v, rhs.v));
+    }
+
+    /*!
+    **  \brief Multiplies the vector by a scalar.
+    **
+    **  \param scalar The rhs of the multiplication.
+    **  \return The scaled vector.
+    */
+    const SimdVector3 operator*(const float &scalar) const
+    {
+        return SimdVector3(Simd::Mul(this->v, Simd::Splat(scalar)));
+    }
+
+    /*!
+    **  \brief Divides the vector by a scalar.
+    **
+    **  \param scalar The rhs of the division.
+    **  \return The scaled vector.
+    */
+    const SimdVector3 operator/(const float &scalar) const
+    {
+        return SimdVector3(*this) /= scalar;
+    }
+
+    /*!
+    **  \brief Returns the cross product of self and rhs.
+    **
+    **  \param rhs The rhs of the cross product.
+    **  \return The cross product.
+    */
+    const SimdVector3 Cross(const SimdVector3 &rhs) const
+    {   // The w elements cancel out, so w stays 0.
+        return SimdVector3(Simd::Sub(Simd::Mul(Simd::YZX(this->v), Simd::ZXY(rhs.v)), Simd::Mul(Simd::ZXY(this->v), Simd::YZX(rhs.v))));
+    }
+
+    /*!
+    **  \brief Returns the dot product of self and rhs.
+    **
+    **  \param rhs The rhs of the dot product.
+    **  \return The dot product.
+    */
+    const float Dot(const SimdVector3 &rhs) const
+    {
+        return Simd::X(Simd::Dot3(this->v, rhs.v));
+    }
+
+    /*!
+    **  \brief Returns the length of the vector.
+    **
+    **  \return The length.
+    */
+    const float Norm(void) const
+    {
+        return Simd::X(Simd::Sqrt(Simd::Dot3(this->v, this->v)));
+    }
+
+    /*!
+    **  \brief Makes the vector unit length (leaves a null vector alone).
+    **
+    **  \return A reference to self.
+    */
+    SimdVector3& Normalise(void)
+    {
+        Simd::Float4 length = Simd::Sqrt(Simd::Dot3(this->v, this->v));
+
+        if(Simd::X(length) != 0.0f)
+        {   // Every element of length is the same, and 0 / length keeps w at 0.
+            this->v = Simd::Div(this->v, length);
+        }
+
+        return *this;
+    }
+
+    Simd::Float4 v;     //!< The elements (x, y, z, 0).
+};
+#endif
@@ -19,10 +19,12 @@
 */
 
 #include <iostream>
+#include <sstream>
 
 #include <cmath>
 
 #include <list>
+#include <algorithm>
 
 #include <SDL.h>
 #include <SDL_OpenGL.h>
@@ -32,10 +34,21 @@
 
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 #include "Box.h"
+#include "Pipe.h"
+#include "PipeReclaimer.h"
+#include "SceneFile.h"
+#include "ChunkFile.h"
+#include "SceneStreamer.h"
+#include "Governor.h"
+#include "FrameTimer.h"
+#include "JobPool.h"
+#include "GLExtensions.h"
 #include "Camera.h"
 #include "DynamicCamera.h"
 #include "ShakyCamera.h"
@@ -52,6 +65,7 @@ void handle_mouse_button_down(Uint8 which, Uint8 button, Uint16 x, Uint16 y);
 void handle_mouse_button_up(Uint8 which, Uint8 button, Uint16 x, Uint16 y);
 void handle_mouse_motion(Uint8 state, Uint16 x, Uint16 y, Sint16 xrel, Sint16 yrel);
 void process_events(void);
+void apply_mouse_motion(void);
 void quit_func(int code);
 
 // Graphics.
@@ -60,8 +74,14 @@ void render(void);
 
 // Application logic.
 void update(float dt);
-void add_box(boost::shared_ptr<Box> box);
+void select_box(std::list<Pipe>::iterator pipe, Box::Handle box);
+void add_box(const Box &box);
 void delete_active(bool ignoreClashes);
+void save_scene(void);
+void load_scene(void);
+void save_chunks(void);
+void toggle_streaming(void);
+void show_governor(void);
 
 // Globals (will be moved to classes after testing.)
 //! \todo Remove the globals
@@ -70,13 +90,29 @@ Vector3 gCameraVelocity;
 bool gOrbit = false;
 std::vector<Vector3> gObserverPoints;
 static const float CAMERATHRESHOLD = 10.0f;
-
-std::list<boost::shared_ptr<Box> > gPipes;          //!< List of all pipes.
-std::list<boost::shared_ptr<Box> >::iterator gHead; //!< Pointer to the head of the active pipe (used to save searching for it when changing the active pipe).
-boost::weak_ptr<Box> gLast;                         //!< Pointer to the last box created (used when adding a box to a pipe).
-boost::weak_ptr<Box> gActive;                       //!< Pointer to the active box (for rotating and translating pipes, and twisting the pipe).
+Matrix4 gProjection;                                //!< The projection matrix set up by setup_opengl (for culling).
+float gPixelScale = 1.0f;                           //!< Pixels covered by one unit, one unit in front of the camera (for level of detail).
+static const float FRAMEBUDGET = 16.6f;             //!< How long process_events, update and render (GPU included) should take, in milliseconds.
+Governor gGovernor(FRAMEBUDGET);                    //!< Trades detail for speed to stay inside FRAMEBUDGET.
+
+std::list<Pipe> gPipes;                             //!< List of all pipes.
+std::list<Pipe>::iterator gHead = gPipes.end();     //!< The active pipe (used to save searching for it when changing the active pipe).
+std::list<Pipe>::iterator gLast = gPipes.end();     //!< The pipe the last box was created in (used when adding a box to a pipe).
+Box::Handle gActive = Box::NONE;                    //!< Handle of the active box in the active pipe (for rotating and translating pipes, and twisting the pipe).
+PipeReclaimer gReclaimer;                           //!< Frees dropped pipes off the frame thread.
+JobPool gJobs(std::max(boost::thread::hardware_concurrency(), 1u) - 1);    //!< Works out where the boxes are on every core (the frame thread makes up the last one).
 static const float PIPEMOVETHRESHOLD = 50.0f;
 static const float PIPEPANTHRESHOLD = 5.0f;
+Vector3 gHeadMove;                                  //!< Mouse movement of the active pipe since the last apply_mouse_motion().
+Quaternion gHeadTurn;                               //!< Mouse rotation of the active pipe since the last apply_mouse_motion(), about its own axes.
+bool gHeadMoved = false;                            //!< Is there any mouse movement or rotation of the active pipe to apply?
+Quaternion gCameraTurn;                             //!< Mouse pitch of the camera since the last apply_mouse_motion(), about its own axes.
+Quaternion gCameraSpin;                             //!< Mouse yaw of the camera since the last apply_mouse_motion(), about the world's up.
+bool gCameraTurned = false;                         //!< Is there any mouse rotation of the camera to apply?
+SceneStreamer gStreamer(gReclaimer, 2);             //!< Streams in the chunks of a chunk file around the camera.
+static const char SCENEFILE[] = "scene.pipes";      //!< Where F5 saves the pipes and F9 loads them from.
+static const char CHUNKFILE[] = "scene.chunks";     //!< Where F6 saves the pipes in chunks and F10 streams them from.
+static const float CHUNKSIZE = 32.0f;
 
 int main(int, char**)
 {   // First, initialize SDL's video subsystem.
@@ -124,6 +160,9 @@ int main(int, char**)
     // So far, so good. Do the OpenGL initialisation stuff.
     setup_opengl(width, height);
 
+    // Long pipes are placed on every core.
+    Pipe::UseJobs(&gJobs);
+
     // Create a camera and move it back a few notches, so that we can see the scene immediatly.
     boost::shared_ptr<Camera> camera(new ElasticShakyThirdPersonCamera(Vector3(0.0f, 0.0f, 5.0f), 1.0f, 2.0f, 15.0f));
     gCamera = camera;
@@ -134,10 +173,16 @@ int main(int, char**)
     gObserverPoints.push_back(Vector3(5.0f, 5.0f, -5.0f));
 
     boost::posix_time::ptime previous(boost::posix_time::microsec_clock::local_time());
+    boost::posix_time::ptime reported(previous);
+
+    // Times the frames for the governor without stalling the pipeline for the GPU.
+    FrameTimer timer;
 
     // Just a simple application loop.
     while(true)
     {   // Process incoming events.
+        timer.Start();
+
         process_events();
 
         boost::posix_time::ptime current(boost::posix_time::microsec_clock::local_time());
@@ -155,6 +200,20 @@ int main(int, char**)
 
         // Draw the screen.
         render();
+
+        // Tell the governor how long all that took. render() only queues the drawing, so the
+        //  GPU's share is read back a frame late rather than waited on (see FrameTimer).
+        gGovernor.Frame(timer.Stop());
+
+        boost::posix_time::ptime finished(boost::posix_time::microsec_clock::local_time());
+
+        if(boost::posix_time::time_period(reported, finished).length().total_milliseconds() >= 1000)
+        {   // Once a second is plenty.
+            reported = finished;
+            show_governor();
+        }
+
+        SDL_GL_SwapBuffers();
     }
 
     return 0;
@@ -171,6 +230,9 @@ void setup_opengl(int width, int height)
     float zfar = 1024.0f;
     float fov = 48.0f;
 
+    // Look up anything newer than OpenGL 1.1.
+    GLExtensions::Load();
+
     // Our shading model--Gouraud (smooth).
     glShadeModel(GL_SMOOTH);
 
@@ -197,6 +259,10 @@ void setup_opengl(int width, int height)
     float xmax = ymax * ratio;
     glFrustum(-xmax, xmax, -ymax, ymax, znear, zfar);
 
+    // Keep a copy for working out what's on screen.
+    glGetFloatv(GL_PROJECTION_MATRIX, gProjection.m);
+    gPixelScale = static_cast<float>(height) * znear / (2.0f * ymax);
+
     return;
 }
 
@@ -213,27 +279,19 @@ void handle_key_down(SDL_keysym* keysym)
         // Home and End move to the first and last pipe.
     case SDLK_HOME:
         {
-            if(boost::shared_ptr<Box> active = gActive.lock())
-            {
-                active->Active(false);  // Deactivate the active box.
+            if(!gPipes.empty())
+            {   // Make the head of the first pipe the new active element.
+                select_box(gPipes.begin(), Pipe::HEAD);
             }
-
-            gHead = gPipes.begin(); // Grad the list head.
-            (*gHead)->Active(true); // Make the head the new active element.
-            gActive = (*gHead);
         }
         break;
 
     case SDLK_END:
         {
-            if(boost::shared_ptr<Box> active = gActive.lock())
-            {
-                active->Active(false);  // Deactivate the active box.
+            if(!gPipes.empty())
+            {   // Make the head of the last pipe the new active element.
+                select_box(--gPipes.end(), Pipe::HEAD);
             }
-
-            gHead = --(gPipes.rbegin().base()); // Grab the list tail.
-            (*gHead)->Active(true);         // Make the tail the new active element.
-            gActive = (*gHead);
         }
         break;
 
@@ -241,32 +299,32 @@ void handle_key_down(SDL_keysym* keysym)
         // Page up and Page down move to the previous and next pipe.
     case SDLK_PAGEUP:
         {
-            if(boost::shared_ptr<Box> active = gActive.lock())
+            if(gHead != gPipes.end())
             {
-                if(gHead != gPipes.begin())
+                std::list<Pipe>::iterator pipe = gHead;
+
+                if(pipe != gPipes.begin())
                 {   // As long as we aren't already at the first pipe,
-                    --gHead;    //  move back a step.
+                    --pipe;     //  move back a step.
                 }
 
-                active->Active(false);
-                (*gHead)->Active(true);
-                gActive = *gHead;
+                select_box(pipe, Pipe::HEAD);
             }
         }
         break;
 
     case SDLK_PAGEDOWN:
         {
-            if(boost::shared_ptr<Box> active = gActive.lock())
+            if(gHead != gPipes.end())
             {
-                if(++gHead == gPipes.end())
+                std::list<Pipe>::iterator pipe = gHead;
+
+                if(++pipe == gPipes.end())
                 {   // If moving forward puts us past the end of the list,
-                    gHead = --(gPipes.rbegin().base()); //  grab the last element.
+                    --pipe;     //  grab the last element.
                 }
 
-                active->Active(false);
-                (*gHead)->Active(true);
-                gActive = *gHead;
+                select_box(pipe, Pipe::HEAD);
             }
         }
         break;
@@ -277,13 +335,14 @@ void handle_key_down(SDL_keysym* keysym)
     case SDLK_EQUALS:   // We handle SDLK_EQUALS as well.
     case SDLK_KP_PLUS:
         {   // Moving up in the world.
-            if(boost::shared_ptr<Box> active = gActive.lock())
-            {   // If the active pointer is valid (it should never not be, but just in case...)
-                if(boost::shared_ptr<Box> next = active->Next())
+            if(gHead != gPipes.end())
+            {   // If there is an active pipe (it should never not be, but just in case...)
+                const Pipe &pipe = *gHead;  // Only reading, so the mesh doesn't need redoing.
+                Box::Handle next = pipe[gActive].Next();
+
+                if(next != Box::NONE)
                 {   // If we aren't already at the end of the list.
-                    active->Active(false);
-                    next->Active(true);
-                    gActive = next;
+                    select_box(gHead, next);
                 }
             }
         }
@@ -292,13 +351,14 @@ void handle_key_down(SDL_keysym* keysym)
     case SDLK_MINUS:
     case SDLK_KP_MINUS:
         {   // Taking a step backward.
-            if(boost::shared_ptr<Box> active = gActive.lock())
-            {   // Again check if the active pointer is valid.
-                if(boost::shared_ptr<Box> prev = active->Prev())
+            if(gHead != gPipes.end())
+            {   // Again check if there is an active pipe.
+                const Pipe &pipe = *gHead;
+                Box::Handle prev = pipe[gActive].Prev();
+
+                if(prev != Box::NONE)
                 {   // And that it's not the head of the list.
-                    active->Active(false);
-                    prev->Active(true);
-                    gActive = prev;
+                    select_box(gHead, prev);
                 }
             }
         }
@@ -371,18 +431,9 @@ void handle_key_up(SDL_keysym* keysym)
     {   // The n key creates a new pipe
     case SDLK_n:
         {   // Create a new pipe.
-            boost::shared_ptr<MasterBox> mBox(new MasterBox(Vector3(0.0f)));
+            gLast = gPipes.insert(gPipes.end(), Pipe(Vector3(0.0f)));
 
-            if(boost::shared_ptr<Box> active = gActive.lock())
-            {
-                active->Active(false);
-            }
-
-            mBox->Active(true);
-
-            gHead = gPipes.insert(gPipes.end(), mBox);
-            gLast = mBox;
-            gActive = mBox;
+            select_box(gLast, Pipe::HEAD);
         }
         break;
 
@@ -390,49 +441,37 @@ void handle_key_up(SDL_keysym* keysym)
         // Keys 1-6 add boxes.
     case SDLK_1:
         {   // Add to the top of the previous box.
-            boost::shared_ptr<Box> box(new Box(0.0f, Vector3(0.0f, 1.0f, 0.0f)));
-
-            add_box(box);
+            add_box(Box(0.0f, Vector3(0.0f, 1.0f, 0.0f)));
         }
         break;
 
     case SDLK_2:
         {   // Add to the front of the previous box.
-            boost::shared_ptr<Box> box(new Box(0.0f, Vector3(0.0f, 0.0f, 1.0f)));
-
-            add_box(box);
+            add_box(Box(0.0f, Vector3(0.0f, 0.0f, 1.0f)));
         }
         break;
 
     case SDLK_3:
         {   // Add to the right of the previous box.
-            boost::shared_ptr<Box> box(new Box(0.0f, Vector3(1.0f, 0.0f, 0.0f)));
-
-            add_box(box);
+            add_box(Box(0.0f, Vector3(1.0f, 0.0f, 0.0f)));
         }
         break;
 
     case SDLK_4:
         {   // Add to the left of the previous box.
-            boost::shared_ptr<Box> box(new Box(0.0f, Vector3(-1.0f, 0.0f, 0.0f)));
-
-            add_box(box);
+            add_box(Box(0.0f, Vector3(-1.0f, 0.0f, 0.0f)));
         }
         break;
 
     case SDLK_5:
         {   // Add to the back of the previous box.
-            boost::shared_ptr<Box> box(new Box(0.0f, Vector3(0.0f, 0.0f, -1.0f)));
-
-            add_box(box);
+            add_box(Box(0.0f, Vector3(0.0f, 0.0f, -1.0f)));
         }
         break;
 
     case SDLK_6:
         {   // Add to the bottom of the previous box.
-            boost::shared_ptr<Box> box(new Box(0.0f, Vector3(0.0f, -1.0f, 0.0f)));
-
-            add_box(box);
+            add_box(Box(0.0f, Vector3(0.0f, -1.0f, 0.0f)));
         }
         break;
 
@@ -527,6 +566,38 @@ void handle_key_up(SDL_keysym* keysym)
         break;
 
 
+    case SDLK_m:
+        {   // Toggles merging the faces of straight runs (handy for checking the merged mesh looks the same).
+            PipeMesh::MergeRuns(!PipeMesh::MergingRuns());
+        }
+        break;
+
+
+    case SDLK_F5:
+        {   // Quick save.
+            save_scene();
+        }
+        break;
+
+    case SDLK_F6:
+        {   // Save in chunks for streaming.
+            save_chunks();
+        }
+        break;
+
+    case SDLK_F9:
+        {   // Quick load.
+            load_scene();
+        }
+        break;
+
+    case SDLK_F10:
+        {   // Start or stop streaming the chunk file.
+            toggle_streaming();
+        }
+        break;
+
+
     default:
         break;
     }
@@ -552,32 +623,26 @@ void handle_mouse_button_down(Uint8 which, Uint8 button, Uint16 x, Uint16 y)
         {
             if(!(SDL_GetMouseState(NULL, NULL) & (SDL_BUTTON(1) | SDL_BUTTON(3))))
             {   // If we aren't trying to modify the active chain.
-                if(boost::shared_ptr<Box> active = gActive.lock())
+                if(gHead != gPipes.end())
                 {   // Rotate the activebox clockwise (or counter? I don't know) as we scroll up.
-                    active->Rotate(1.0f);
+                    gHead->Rotate(gActive, 1.0f);
                 }
                 break;
             }
 
             if(SDL_GetMouseState(NULL, NULL) & SDL_BUTTON(1))
             {   // Trying to translate the active chain.
-                if(boost::shared_ptr<Box> active = gActive.lock())
+                if(gHead != gPipes.end())
                 {   // If there's a chain to translate of course.
-                    if(boost::shared_ptr<MasterBox> head = boost::shared_dynamic_cast<MasterBox>(*gHead))
-                    {
-                        head->Dolly(Vector3(0.0f, 5.0f / PIPEMOVETHRESHOLD, 0.0f));
-                    }
+                    gHead->Head().Dolly(Vector3(0.0f, 5.0f / PIPEMOVETHRESHOLD, 0.0f));
                 }
             }
 
             if(SDL_GetMouseState(NULL, NULL) & SDL_BUTTON(3))
             {   // Trying to rotate the active chain.
-                if(boost::shared_ptr<Box> active = gActive.lock())
+                if(gHead != gPipes.end())
                 {   // If there's a chain to rotate of course.
-                    if(boost::shared_ptr<MasterBox> head = boost::shared_dynamic_cast<MasterBox>(*gHead))
-                    {
-                        head->Yaw(Quaternion::DegreesToRadians(5.0f / PIPEPANTHRESHOLD));
-                    }
+                    gHead->Head().Yaw(Quaternion::DegreesToRadians(5.0f / PIPEPANTHRESHOLD));
                 }
             }
         }
@@ -587,32 +652,26 @@ void handle_mouse_button_down(Uint8 which, Uint8 button, Uint16 x, Uint16 y)
         {
             if(!(SDL_GetMouseState(NULL, NULL) & (SDL_BUTTON(1) | SDL_BUTTON(3))))
             {   // If we aren't trying to modify the active chain.
-                if(boost::shared_ptr<Box> active = gActive.lock())
+                if(gHead != gPipes.end())
                 {   // And rotate the other way as we scroll down.
-                    active->Rotate(-1.0f);
+                    gHead->Rotate(gActive, -1.0f);
                 }
                 break;
             }
 
             if(SDL_GetMouseState(NULL, NULL) & SDL_BUTTON(1))
             {   // Trying to translate the active chain.
-                if(boost::shared_ptr<Box> active = gActive.lock())
+                if(gHead != gPipes.end())
                 {   // If there's a chain to translate of course.
-                    if(boost::shared_ptr<MasterBox> head = boost::shared_dynamic_cast<MasterBox>(*gHead))
-                    {
-                        head->Dolly(Vector3(0.0f, -5.0f / PIPEMOVETHRESHOLD, 0.0f));
-                    }
+                    gHead->Head().Dolly(Vector3(0.0f, -5.0f / PIPEMOVETHRESHOLD, 0.0f));
                 }
             }
 
             if(SDL_GetMouseState(NULL, NULL) & SDL_BUTTON(3))
             {   // Trying to rotate the active chain.
-                if(boost::shared_ptr<Box> active = gActive.lock())
+                if(gHead != gPipes.end())
                 {   // If there's a chain to rotate of course.
-                    if(boost::shared_ptr<MasterBox> head = boost::shared_dynamic_cast<MasterBox>(*gHead))
-                    {
-                        head->Yaw(Quaternion::DegreesToRadians(-5.0f / PIPEPANTHRESHOLD));
-                    }
+                    gHead->Head().Yaw(Quaternion::DegreesToRadians(-5.0f / PIPEPANTHRESHOLD));
                 }
             }
         }
@@ -651,37 +710,54 @@ void handle_mouse_button_up(Uint8 which, Uint8 button, Uint16 x, Uint16 y)
 }
 
 void handle_mouse_motion(Uint8 state, Uint16 x, Uint16 y, Sint16 xrel, Sint16 yrel)
-{
+{   // A fast mouse sends a lot of these a frame, so they're only added up here and
+    //  apply_mouse_motion() moves things once all the events are in.
     if(state & SDL_BUTTON(1))
     {   // If the left mouse button is down we translate the active chain.
-        if(boost::shared_ptr<Box> active = gActive.lock())
-        {   // If there's a chain to translate of course.
-            if(boost::shared_ptr<MasterBox> head = boost::shared_dynamic_cast<MasterBox>(*gHead))
-            {
-                head->Dolly(Vector3(static_cast<float>(xrel) / PIPEMOVETHRESHOLD, 0.0f, static_cast<float>(yrel) / PIPEMOVETHRESHOLD));
-            }
-        }
+        gHeadMove += Vector3(static_cast<float>(xrel) / PIPEMOVETHRESHOLD, 0.0f, static_cast<float>(yrel) / PIPEMOVETHRESHOLD);
+        gHeadMoved = true;
     }
 
     if(state & SDL_BUTTON(3))
-    {   // If the right mouse button is down we rotate the active chain.
-        if(boost::shared_ptr<Box> active = gActive.lock())
-        {   // If there's a chain to pan of course.
-            if(boost::shared_ptr<MasterBox> head = boost::shared_dynamic_cast<MasterBox>(*gHead))
-            {
-                head->Roll(Quaternion::DegreesToRadians(static_cast<float>(xrel) / PIPEPANTHRESHOLD));
-                head->Pitch(Quaternion::DegreesToRadians(static_cast<float>(yrel) / PIPEPANTHRESHOLD));
-            }
-        }
+    {   // If the right mouse button is down we rotate the active chain, a roll then a pitch.
+        gHeadTurn = gHeadTurn * Quaternion(Vector3(0.0f, 0.0f, 1.0f), Quaternion::DegreesToRadians(static_cast<float>(xrel) / PIPEPANTHRESHOLD))
+                              * Quaternion(Vector3(1.0f, 0.0f, 0.0f), Quaternion::DegreesToRadians(static_cast<float>(yrel) / PIPEPANTHRESHOLD));
+        gHeadMoved = true;
     }
     if(state & SDL_BUTTON(2))
-    {   // If the middle mouse button is down we pan the camera.
+    {   // If the middle mouse button is down we pan the camera, a pitch then a turn about the world's up.
+        gCameraTurn = gCameraTurn * Quaternion(Vector3(1.0f, 0.0f, 0.0f), Quaternion::DegreesToRadians(static_cast<float>(yrel) / CAMERATHRESHOLD));
+        gCameraSpin = Quaternion(Vector3(0.0f, 1.0f, 0.0f), Quaternion::DegreesToRadians(static_cast<float>(xrel) / CAMERATHRESHOLD)) * gCameraSpin;
+        gCameraTurned = true;
+    }
+    return;
+}
+
+void apply_mouse_motion(void)
+{   // Turns about the world's axes multiply on the left and turns about an object's own axes
+    //  on the right, so each side can be added up on its own and still end up in the same place.
+    if(gHeadMoved && gHead != gPipes.end())
+    {   // If there's a chain to move of course.
+        gHead->Head().Dolly(gHeadMove);
+        gHead->Head().Turn(gHeadTurn);
+    }
+
+    if(gCameraTurned)
+    {
         if(boost::shared_ptr<Camera> camera = gCamera.lock())
         {   // If there's a camera to pan of course.
-            camera->Pitch(Quaternion::DegreesToRadians(static_cast<float>(yrel) / CAMERATHRESHOLD));
-            camera->Pan(Quaternion(Vector3(0.0f, 1.0f, 0.0f), Quaternion::DegreesToRadians(static_cast<float>(xrel) / CAMERATHRESHOLD)));
+            camera->Pan(gCameraSpin);
+            camera->Turn(gCameraTurn);
         }
     }
+
+    gHeadMove = Vector3();
+    gHeadTurn = Quaternion();
+    gHeadMoved = false;
+    gCameraTurn = Quaternion();
+    gCameraSpin = Quaternion();
+    gCameraTurned = false;
+
     return;
 }
 
@@ -693,6 +769,11 @@ void process_events(void)
     // Grab all the events off the queue.
     while(SDL_PollEvent(&event))
     {
+        if(event.type != SDL_MOUSEMOTION)
+        {   // Anything else might change what the mouse is moving, so catch up first.
+            apply_mouse_motion();
+        }
+
         switch(event.type)
         {
         case SDL_KEYDOWN:
@@ -730,6 +811,8 @@ void process_events(void)
         }
     }
 
+    apply_mouse_motion();
+
     return;
 }
 
@@ -755,33 +838,59 @@ void render(void)
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
+    Matrix4 view;
+    Vector3 eye;
+    Vector3 forward(0.0f, 0.0f, -1.0f);
+
     //! \todo Move this code to a scene class.
     if(boost::shared_ptr<Camera> camera = gCamera.lock())
     {
         camera->Render();
+        view = camera->ViewMatrix();
+        eye = camera->Position();
+        forward = camera->Forward();
     }
 
+    // Anything outside this isn't drawn, and anything far enough away is drawn in low detail.
+    //  How far and how soon is up to the governor.
+    Frustum frustum(gProjection * view);
+    frustum.Limit(eye, forward, gGovernor.Reach());
+
+    const Detail detail(eye, gPixelScale * gGovernor.Quality());
+
     axes.Draw();
 
     //! \todo Move this code to a BoxManager class.
     glEnableClientState(GL_NORMAL_ARRAY);
     glEnableClientState(GL_COLOR_ARRAY);
     glEnableClientState(GL_VERTEX_ARRAY);
-    glNormalPointer(GL_FLOAT, 0, Box::normals);
-    glColorPointer(3, GL_FLOAT, 0, Box::colours);
-    glVertexPointer(3, GL_FLOAT, 0, Box::vertices);
 
-    for(std::list<boost::shared_ptr<Box> >::const_iterator it = gPipes.begin(); it != gPipes.end(); ++it)
+    // Bring every pipe that changed up to date in parallel, then draw them all in one pass.
+    for(std::list<Pipe>::const_iterator it = gPipes.begin(); it != gPipes.end(); ++it)
     {
-        (*it)->Draw();
+        if(!it->Current())
+        {   // Most pipes sit still from one frame to the next, a job for each would be all overhead.
+            gJobs.Add(boost::bind(&Pipe::Prepare, &*it, boost::ref(gJobs)));
+        }
     }
 
+    gStreamer.Prepare(gJobs);
+    gJobs.Wait();
+
+    for(std::list<Pipe>::const_iterator it = gPipes.begin(); it != gPipes.end(); ++it)
+    {
+        it->Draw(frustum, detail);
+    }
+
+    gStreamer.Draw(frustum, detail);
+
+    // Clean up after any pipes that were freed since the last frame.
+    PipeMesh::DeleteOrphans();
+
     glDisableClientState(GL_VERTEX_ARRAY);
     glDisableClientState(GL_COLOR_ARRAY);
     glDisableClientState(GL_NORMAL_ARRAY);
 
-    SDL_GL_SwapBuffers();
-
     return;
 }
 
@@ -850,102 +959,100 @@ void update(float dt)
         }
     }
 
+    // Load whatever part of a streamed scene the camera is in now.
+    gStreamer.Update(camera->Position());
+
     // LETS DO THE TIME WARP AGAIIIIIIIIIIIN!
     return;
 }
 
-void add_box(boost::shared_ptr<Box> box)
+void select_box(std::list<Pipe>::iterator pipe, Box::Handle box)
 {
-    if(boost::shared_ptr<Box> last = gLast.lock())
-    {   // If the last pointer is still valid (will only fail if there are no boxes on screen)
-        if(last->SetNext(box))
-        {   // Try set the next pointer. If it fails it's probably because the next box will
-            //  be drawn inside the previous box, and we don't want that.
-            box->SetPrev(last);
-            gLast = box;
-        }
+    if(gHead != gPipes.end())
+    {
+        (*gHead)[gActive].Active(false);    // Deactivate the active box.
+    }
+
+    gHead = pipe;
+    gActive = box;
+
+    if(gHead != gPipes.end())
+    {
+        (*gHead)[gActive].Active(true);     // Make the new box the active element.
     }
 
     return;
 }
 
-void delete_active(bool ignoreClashes)
+void add_box(const Box &box)
 {
-    if(boost::shared_ptr<Box> active = gActive.lock())
-    {
-        if(boost::shared_ptr<Box> prev = active->Prev())
-        {   // If there is a previous pointer, we're deleting an element of a pipe.
-            boost::shared_ptr<Box> next = active->Next();
+    if(gLast != gPipes.end())
+    {   // If the last pipe is still valid (will only fail if there are no boxes on screen)
+        //  try add the box to the end. If it fails it's probably because the next box
+        //  will be drawn inside the previous box, and we don't want that.
+        gLast->Append(box);
+    }
 
-            bool wasClash = false;  // Tracks whether there actually was a clash so that
-                                    //  shift+backspace wont remove the entire tail unnecessarily.
+    return;
+}
 
-            if(prev->SetNext(next) || (ignoreClashes && (wasClash = true)))
-            {   // If there's a problem setting the next pointer
-                //  (generally an invalid axis) SetNext returns false,
+void delete_active(bool ignoreClashes)
+{
+    if(gHead != gPipes.end())
+    {
+        const Pipe &pipe = *gHead;
+        Box::Handle prev = pipe[gActive].Prev();
+
+        if(prev != Box::NONE)
+        {   // If there is a previous box, we're deleting an element of a pipe.
+            if(gHead->Remove(gActive) || ignoreClashes)
+            {   // If there's a problem joining the neighbours
+                //  (generally an invalid axis) Remove returns false,
                 //  but if we really wanna delete the box then we do it anyway.
-
-                if(wasClash)
-                {   // If there was a clash.
-                    next.reset();           // Clear the pointer,
-                    prev->SetNext(next);    //  and try again.
-
-                    // This has the effect of dropping the rest of the list from the active element.
-                }
-
-                if(!next)
-                {   // If there was no next pointer, we must be deleting the tail.
-                    if(gLast.lock() == active)
-                    {   // If we're deleting the last element, then we want to update the link.
-                        gLast = prev;
-                    }
-                }
-                else
-                {   // Otherwise, make the reverse link.
-                    next->SetPrev(prev);
+                if(pipe[prev].Next() == gActive)
+                {   // If there was a clash the box is still there, so drop the
+                    //  rest of the list from the active element.
+                    gHead->Truncate(gActive);
                 }
 
-                prev->Active(true);
                 gActive = prev;
+                (*gHead)[gActive].Active(true);
             }
         }
         else
-        {   // If there's no previous pointer, we must be trying to delete the head of a pipe.
-            if(boost::shared_ptr<Box> next = active->Next())
-            {   // If this is part of a pipe
-                boost::shared_ptr<MasterBox> newHead(new MasterBox(*next));
-                newHead->Active(true);
-                gActive = newHead;
-
-                if(!next->Next())
-                {   // If we're making the last box created the new head we lose the pointer to it
-                    //  since we recreate the object, so update the gLast pointer.
-                    gLast = newHead;
-                }
-
-                std::list<boost::shared_ptr<Box> >::iterator it = gPipes.erase(gHead);
-                gHead = gPipes.insert(it, newHead);
+        {   // If there's no previous box, we must be trying to delete the head of a pipe.
+            if(gHead->PromoteNext())
+            {   // If this is part of a pipe the next box is now the head.
+                gHead->Head().Active(true);
             }
             else
             {   // Must be an isolated element, just drop it.
-                gHead = gPipes.erase(gHead);
+                if(gLast == gHead)
+                {   // We're deleting the pipe new boxes go to.
+                    gLast = gPipes.end();
+                }
+
+                std::list<Pipe>::iterator dropped = gHead++;
+                gReclaimer.Reclaim(gPipes, dropped);
 
                 if(!(gPipes.empty()))
                 {
                     if(gHead == gPipes.end())
-                    {   // We're deleting the last box created, and it's the head of a list.
-                        // Need to find the new last box. Thankfully this isn't hard.
-                        gHead = --(gPipes.rbegin().base());
-                        gLast = *gHead;
+                    {   // We're deleting the last pipe in the list, step back one.
+                        --gHead;
+                    }
+
+                    if(gLast == gPipes.end())
+                    {   // Need to find the new last pipe. Thankfully this isn't hard.
+                        gLast = --gPipes.end();
                     }
 
-                    (*gHead)->Active(true);
-                    gActive = *gHead;
+                    gActive = Pipe::HEAD;
+                    (*gHead)[gActive].Active(true);
                 }
                 else
                 {   // We deleted all the pipes :(
-                    gActive.reset();
-                    gLast.reset();
+                    gActive = Box::NONE;
                 }
             }
         }
@@ -953,3 +1060,78 @@ void delete_active(bool ignoreClashes)
 
     return;
 }
+
+void save_scene(void)
+{
+    if(!SceneFile::Save(SCENEFILE, gPipes))
+    {
+        std::cerr << "Couldn't save the pipes to " << SCENEFILE << std::endl;
+    }
+
+    return;
+}
+
+void load_scene(void)
+{
+    std::list<Pipe> loaded;
+
+    if(!SceneFile::Load(SCENEFILE, loaded))
+    {   // Leave the current scene alone.
+        std::cerr << "Couldn't load the pipes from " << SCENEFILE << std::endl;
+        return;
+    }
+
+    // Big scenes take a while to free, so let the reclaimer deal with the old one.
+    gReclaimer.Reclaim(gPipes);
+
+    gPipes.splice(gPipes.end(), loaded);
+
+    gHead = gPipes.end();
+    gLast = gPipes.empty() ? gPipes.end() : --gPipes.end();
+    gActive = Box::NONE;
+
+    if(!gPipes.empty())
+    {
+        select_box(gPipes.begin(), Pipe::HEAD);
+    }
+
+    return;
+}
+
+void save_chunks(void)
+{
+    if(!ChunkFile::Save(CHUNKFILE, gPipes, CHUNKSIZE))
+    {
+        std::cerr << "Couldn't save the chunks to " << CHUNKFILE << std::endl;
+    }
+
+    return;
+}
+
+void toggle_streaming(void)
+{
+    if(gStreamer.IsOpen())
+    {
+        gStreamer.Close();
+    }
+    else if(!gStreamer.Open(CHUNKFILE))
+    {
+        std::cerr << "Couldn't stream the chunks from " << CHUNKFILE << std::endl;
+    }
+
+    return;
+}
+
+void show_governor(void)
+{   // Shows what the governor has traded away in the title bar.
+    std::ostringstream caption;
+
+    caption.setf(std::ios::fixed);
+    caption.precision(1);
+    caption << "Pipes - " << gGovernor.Average() << "/" << gGovernor.Budget() << " ms"
+            << ", level " << gGovernor.Level() << " (detail 1/" << static_cast<int>(1.0f / gGovernor.Quality() + 0.5f) << ", reach " << gGovernor.Reach() << ")";
+
+    SDL_WM_SetCaption(caption.str().c_str(), 0);
+
+    return;
+}